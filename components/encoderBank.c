@@ -0,0 +1,146 @@
+#pragma systemFile
+
+#if !defined(ENCODERBANK_C_)
+#define ENCODERBANK_C_
+
+#define ENCODERBANK_CAPACITY	8
+
+#include "./encoderWheel.c"
+#include "./sensorFrame.c"
+
+// Encoder wheels read together. update() reads every port back to back, so
+// all distances come from the same instant, then computes each wheel's
+// distance and change since the last update with its cached distance per
+// pulse.
+typedef struct {
+	short size;
+	EncoderWheel *wheels[ENCODERBANK_CAPACITY];  // May be NULL.
+
+	long pulses[ENCODERBANK_CAPACITY];
+	float distances[ENCODERBANK_CAPACITY];
+	float deltas[ENCODERBANK_CAPACITY];
+} EncoderBank;
+
+EncoderBank *newEncoderBank(EncoderBank *this) {
+	if (this) {
+		this->size = 0;
+	}
+	return this;
+}
+
+/**
+ * Replace the encoder wheel at an index. Its change is measured from now.
+ */
+void setEncoderWheel(EncoderBank *this, short index, EncoderWheel *wheel) {
+	if (this == NULL || index < 0 || index >= this->size) {
+		return;
+	}
+	this->wheels[index] = wheel;
+	this->pulses[index] = wheel ? SensorValue[wheel->port] : 0;
+	this->distances[index] = getDistance(wheel);
+	this->deltas[index] = 0.0;
+}
+
+/**
+ * Add an encoder wheel to the bank.
+ *
+ * @param 	this 	Pointer to EncoderBank struct.
+ * @param 	wheel	Pointer to EncoderWheel struct, or NULL for a wheel that
+ *        	     	always reads 0.
+ *
+ * @return	Index of the wheel, or -1 if the bank is full.
+ */
+short addEncoderWheel(EncoderBank *this, EncoderWheel *wheel) {
+	if (this == NULL || this->size >= ENCODERBANK_CAPACITY) {
+		return -1;
+	}
+	this->size++;
+	setEncoderWheel(this, this->size - 1, wheel);
+
+	return this->size - 1;
+}
+
+short getSize(EncoderBank *this) {
+	return this ? this->size : 0;
+}
+
+EncoderWheel *getEncoderWheel(EncoderBank *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->wheels[index] : NULL;
+}
+
+/**
+ * Update distances and changes from the snapshot in pulses.
+ */
+void updateDistances(EncoderBank *this) {
+	for (short i = 0; i < this->size; i++) {
+		float distance = this->wheels[i]
+				? this->pulses[i] * this->wheels[i]->distancePerPulse : 0.0;
+
+		this->deltas[i] = distance - this->distances[i];
+		this->distances[i] = distance;
+	}
+}
+
+/**
+ * Snapshot every encoder, then update distances and changes.
+ *
+ * @param 	this	Pointer to EncoderBank struct.
+ */
+void update(EncoderBank *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		if (this->wheels[i]) {
+			this->pulses[i] = SensorValue[this->wheels[i]->port];
+		}
+	}
+	updateDistances(this);
+}
+
+/**
+ * Update distances and changes from the pulse counts in a sensor frame.
+ *
+ * @param 	this 	Pointer to EncoderBank struct.
+ * @param 	frame	Pointer to SensorFrame struct.
+ */
+void update(EncoderBank *this, SensorFrame *frame) {
+	if (this == NULL || frame == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		if (this->wheels[i]) {
+			this->pulses[i] = getValue(frame, this->wheels[i]->port);
+		}
+	}
+	updateDistances(this);
+}
+
+/**
+ * Get a wheel's distance at the last update().
+ */
+float getDistance(EncoderBank *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->distances[index] : 0.0;
+}
+
+/**
+ * Get a wheel's change in distance between the last two update()s.
+ */
+float getDelta(EncoderBank *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->deltas[index] : 0.0;
+}
+
+void print(EncoderBank *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		writeDebugStream("%d: distance=%f; delta=%f\n", i, this->distances[i],
+				this->deltas[i]);
+	}
+}
+
+#endif  // ENCODERBANK_C_
@@ -0,0 +1,204 @@
+#pragma systemFile
+
+#if !defined(ENCODERVELOCITY_C_)
+#define ENCODERVELOCITY_C_
+
+#define ENCODERVELOCITY_BUFFER_SIZE	32
+
+#include "../util/math.c"
+#include "./encoderWheel.c"
+#include "./sensorFrame.c"
+
+// Velocity from a ring buffer of timestamped pulse counts. Each update picks
+// the shortest window, at least minWindow, that holds minPulses pulses, up to
+// maxWindow. At high speed the window is short for low latency; at low speed
+// it grows so quantization noise stays near 1 / minPulses of the velocity.
+// The trade-off is exposed per update: latency is about window / 2, and the
+// velocity resolution is one pulse per window.
+//
+// The buffer keeps at most one count per maxWindow / (BUFFER_SIZE - 1) ms,
+// so it spans maxWindow however often update() is called. Windows are
+// measured back from the latest count to a kept one, so with fast updates
+// they come in steps of that spacing (9 ms for the default 250 ms).
+typedef struct {
+	EncoderWheel *encoder;
+	short minPulses;
+	long minWindow;  // ms.
+	long maxWindow;  // ms.
+
+	long times[ENCODERVELOCITY_BUFFER_SIZE];
+	long pulses[ENCODERVELOCITY_BUFFER_SIZE];
+	float velocities[ENCODERVELOCITY_BUFFER_SIZE];
+	short head;  // Newest kept sample.
+	short count;
+	long spacing;  // Minimum time between kept samples (ms).
+	long lastPulses;
+	long lastTime;
+	long lastChangeTime;  // Time the pulse count last changed (ms).
+
+	float velocity;      // units/s.
+	float acceleration;  // units/s^2.
+	long window;         // ms.
+} EncoderVelocity;
+
+/**
+ * Initialize encoder velocity estimator.
+ *
+ * @param 	this     	Pointer to EncoderVelocity struct.
+ * @param 	encoder  	Encoder wheel to measure.
+ * @param 	minPulses	Pulses wanted in the window.
+ * @param 	minWindow	Shortest window (ms).
+ * @param 	maxWindow	Longest window (ms).
+ *
+ * @return	Pointer to EncoderVelocity struct.
+ */
+EncoderVelocity *newEncoderVelocity(EncoderVelocity *this,
+		EncoderWheel *encoder, short minPulses, long minWindow, long maxWindow) {
+	if (this) {
+		this->encoder = encoder;
+		this->minPulses = minPulses;
+		this->minWindow = minWindow;
+		this->maxWindow = maxWindow;
+
+		this->head = 0;
+		this->count = 0;
+		// Rounded up, so BUFFER_SIZE - 1 spacings reach maxWindow.
+		this->spacing = (maxWindow + ENCODERVELOCITY_BUFFER_SIZE - 2)
+				/ (ENCODERVELOCITY_BUFFER_SIZE - 1);
+		this->lastPulses = 0;
+		this->lastTime = 0;
+		this->lastChangeTime = 0;
+
+		this->velocity = 0.0;
+		this->acceleration = 0.0;
+		this->window = 0;
+	}
+	return this;
+}
+
+EncoderVelocity *newEncoderVelocity(EncoderVelocity *this,
+		EncoderWheel *encoder) {
+	return newEncoderVelocity(this, encoder, 8, 10, 250);
+}
+
+float getVelocity(EncoderVelocity *this) {
+	return this ? this->velocity : 0.0;
+}
+
+float getAcceleration(EncoderVelocity *this) {
+	return this ? this->acceleration : 0.0;
+}
+
+/**
+ * Get the window used by the last update (ms). Latency is about half of it.
+ */
+long getWindow(EncoderVelocity *this) {
+	return this ? this->window : 0;
+}
+
+/**
+ * Get the velocity step of one pulse over the last window (units/s).
+ */
+float getResolution(EncoderVelocity *this) {
+	return (this != NULL && this->window > 0)
+			? fabs(getDistancePerPulse(this->encoder)) * 1000.0 / this->window : 0.0;
+}
+
+/**
+ * Add a pulse count and update velocity and acceleration.
+ *
+ * @param 	this  	Pointer to EncoderVelocity struct.
+ * @param 	pulses	Raw pulse count.
+ * @param 	time  	Time of the count (ms).
+ */
+void update(EncoderVelocity *this, long pulses, long time) {
+	if (this == NULL) {
+		return;
+	}
+	if (this->count > 0 && time <= this->lastTime) {
+		return;  // Nothing new.
+	}
+	if (this->count == 0 || pulses != this->lastPulses) {
+		this->lastChangeTime = time;
+	}
+	this->lastPulses = pulses;
+	this->lastTime = time;
+
+	bool kept = this->count == 0
+			|| time - this->times[this->head] >= this->spacing;
+
+	if (kept) {
+		if (this->count > 0) {
+			this->head = (this->head + 1) % ENCODERVELOCITY_BUFFER_SIZE;
+		}
+		this->count = min(this->count + 1, ENCODERVELOCITY_BUFFER_SIZE);
+		this->times[this->head] = time;
+		this->pulses[this->head] = pulses;
+	}
+
+	// Walk back to the shortest window that is long enough.
+	short j = -1;
+	for (short k = 0; k < this->count; k++) {
+		short i = (this->head - k + ENCODERVELOCITY_BUFFER_SIZE)
+				% ENCODERVELOCITY_BUFFER_SIZE;
+		long dt = time - this->times[i];
+
+		if (dt <= 0) {
+			continue;  // The sample just kept.
+		}
+		j = i;
+		if (dt >= this->maxWindow || (dt >= this->minWindow
+				&& abs(pulses - this->pulses[i]) >= this->minPulses)) {
+			break;
+		}
+	}
+	this->window = (j >= 0) ? time - this->times[j] : 0;
+
+	if (this->window > 0) {
+		float distancePerPulse = getDistancePerPulse(this->encoder);
+
+		this->velocity = (pulses - this->pulses[j]) * distancePerPulse * 1000.0
+				/ this->window;
+
+		// 1/T bound: no pulse since lastChangeTime means the speed is at most
+		// one pulse over that time, so stops show up without waiting for the
+		// window to empty.
+		long sinceChange = time - this->lastChangeTime;
+		if (sinceChange > 0) {
+			float bound = fabs(distancePerPulse) * 1000.0 / sinceChange;
+
+			this->velocity = max(min(this->velocity, bound), -bound);
+		}
+		this->acceleration = (this->velocity - this->velocities[j]) * 1000.0
+				/ this->window;
+	}
+	if (kept) {
+		this->velocities[this->head] = this->velocity;
+	}
+}
+
+void update(EncoderVelocity *this) {
+	if (this == NULL || this->encoder == NULL) {
+		return;
+	}
+	update(this, SensorValue[this->encoder->port], nSysTime);
+}
+
+void update(EncoderVelocity *this, SensorFrame *frame) {
+	if (this == NULL || this->encoder == NULL || frame == NULL) {
+		return;
+	}
+	update(this, getValue(frame, this->encoder->port), getTime(frame));
+}
+
+void print(EncoderVelocity *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Velocity: %f\n", this->velocity);
+	writeDebugStream("Acceleration: %f\n", this->acceleration);
+	writeDebugStream("Window: %d ms; resolution: %f\n", this->window,
+			getResolution(this));
+}
+
+#endif  // ENCODERVELOCITY_C_
@@ -3,6 +3,7 @@
 #if !defined(ENCODERWHEEL_C_)
 #define ENCODERWHEEL_C_
 
+#include "./sensorFrame.c"
 #include "../util/string.c"
 
 typedef struct {
@@ -12,8 +13,23 @@ typedef struct {
 	float gearRatio;
 	float slipFactor;
 	bool inverted;
+
+	float distancePerPulse;  // Signed, so inversion is included.
 } EncoderWheel;
 
+/**
+ * Recompute the cached distance per pulse. Called by every setter that
+ * changes it.
+ */
+void updateDistancePerPulse(EncoderWheel *this) {
+	float pulsesPerDistance = this->pulsesPerRev * this->gearRatio
+			* this->slipFactor;
+
+	this->distancePerPulse = (pulsesPerDistance != 0.0)
+			? (this->inverted ? -1 : 1) * PI * this->wheelDiameter / pulsesPerDistance
+			: 0.0;
+}
+
 EncoderWheel *newEncoderWheel(EncoderWheel *this, tSensors port,
 		float pulsesPerRev, float wheelDiameter, float gearRatio,
 		float slipFactor, bool inverted) {
@@ -24,6 +40,8 @@ EncoderWheel *newEncoderWheel(EncoderWheel *this, tSensors port,
 		this->gearRatio = gearRatio;
 		this->slipFactor = slipFactor;
 		this->inverted = inverted;
+
+		updateDistancePerPulse(this);
 	}
 	return this;
 }
@@ -81,6 +99,7 @@ float getPulsesPerRev(EncoderWheel *this) {
 void setPulsesPerRev(EncoderWheel *this, float pulsesPerRev) {
 	if (this) {
 		this->pulsesPerRev = pulsesPerRev;
+		updateDistancePerPulse(this);
 	}
 }
 
@@ -91,6 +110,7 @@ float getWheelDiameter(EncoderWheel *this) {
 void setWheelDiameter(EncoderWheel *this, float wheelDiameter) {
 	if (this) {
 		this->wheelDiameter = wheelDiameter;
+		updateDistancePerPulse(this);
 	}
 }
 
@@ -101,6 +121,7 @@ float getGearRatio(EncoderWheel *this) {
 void setGearRatio(EncoderWheel *this, float gearRatio) {
 	if (this) {
 		this->gearRatio = gearRatio;
+		updateDistancePerPulse(this);
 	}
 }
 
@@ -111,6 +132,7 @@ float getSlipFactor(EncoderWheel *this) {
 void setSlipFactor(EncoderWheel *this, float slipFactor) {
 	if (this) {
 		this->slipFactor = slipFactor;
+		updateDistancePerPulse(this);
 	}
 }
 
@@ -121,6 +143,7 @@ bool getInverted(EncoderWheel *this) {
 void setInverted(EncoderWheel *this, bool inverted) {
 	if (this) {
 		this->inverted = inverted;
+		updateDistancePerPulse(this);
 	}
 }
 
@@ -128,9 +151,19 @@ long getPulses(EncoderWheel *this) {
 	return this ? (this->inverted ? -1 : 1) * SensorValue[this->port] : 0;
 }
 
+float getDistancePerPulse(EncoderWheel *this) {
+	return this ? this->distancePerPulse : 0.0;
+}
+
 float getDistance(EncoderWheel *this) {
-	return this ? (getPulses(this) * PI * this->wheelDiameter)
-			/ (this->pulsesPerRev * this->gearRatio * this->slipFactor) : 0.0;
+	return this ? SensorValue[this->port] * this->distancePerPulse : 0.0;
+}
+
+/**
+ * Get the distance from the pulse count in a sensor frame.
+ */
+float getDistance(EncoderWheel *this, SensorFrame *frame) {
+	return this ? getValue(frame, this->port) * this->distancePerPulse : 0.0;
 }
 
 void print(EncoderWheel *this) {
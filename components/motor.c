@@ -3,9 +3,99 @@
 #if !defined(MOTOR_C_)
 #define MOTOR_C_
 
-void motorSetLinear(tMotor port, short speed) {
+#include "../util/math.c"
+
+#define MOTOR_NOMINAL_BATTERY_LEVEL 	7200.0  // mV.
+#define MOTOR_BATTERY_FILTER_GAIN   	0.05
+#define MOTOR_BATTERY_UPDATE_PERIOD 	15      // ms.
+#define MOTOR_MAX_OUTPUT            	127
+
+// Filtered battery voltage (mV) and the output scale derived from it. Both are
+// refreshed together by motorUpdateBattery() so that the per-call cost of
+// compensating an output is a single multiply.
+float motorBatteryLevel = 0.0;
+float motorBatteryScale = 1.0;
+
+/**
+ * Update the filtered battery voltage estimate and cache the output scale
+ * factor. Call once per tick from a background task.
+ */
+void motorUpdateBattery() {
+	float level = nAvgBatteryLevel;
+
+	if (level <= 0.0) {
+		return;  // No reading yet.
+	}
+	if (motorBatteryLevel <= 0.0) {
+		motorBatteryLevel = level;  // Seed the filter with the first reading.
+	} else {
+		motorBatteryLevel += MOTOR_BATTERY_FILTER_GAIN * (level - motorBatteryLevel);
+	}
+	motorBatteryScale = MOTOR_NOMINAL_BATTERY_LEVEL / motorBatteryLevel;
+}
+
+/**
+ * Keep the battery estimate current. Start once with
+ * startTask(motorBatteryTask).
+ */
+task motorBatteryTask() {
+	while (true) {
+		motorUpdateBattery();
+
+		sleep(MOTOR_BATTERY_UPDATE_PERIOD);
+	}
+}
+
+/**
+ * Get the filtered battery voltage.
+ *
+ * @return	Filtered battery voltage (mV), or the nominal voltage if
+ *        	motorUpdateBattery() has not run yet.
+ */
+float motorGetBatteryLevel() {
+	return (motorBatteryLevel > 0.0) ? motorBatteryLevel
+			: MOTOR_NOMINAL_BATTERY_LEVEL;
+}
+
+/**
+ * Scale an output given at the nominal battery voltage to the current
+ * battery voltage. If motorBatteryTask is not running, the voltage is the
+ * first reading taken.
+ *
+ * @param 	output	Output at nominal voltage.
+ *
+ * @return	Compensated output, limited to +/-127.
+ */
+short motorCompensate(float output) {
+	// Without motorBatteryTask, seed from the current reading, so outputs
+	// are still compensated.
+	if (motorBatteryLevel <= 0.0) {
+		motorUpdateBattery();
+	}
+	return (short)limit(output * motorBatteryScale, MOTOR_MAX_OUTPUT);
+}
+
+/**
+ * Set a motor to an output given at the nominal battery voltage.
+ *
+ * @param 	port  	Motor port.
+ * @param 	output	Output at nominal voltage.
+ */
+void motorSetCompensated(tMotor port, float output) {
+	motor[port] = motorCompensate(output);
+}
+
+/**
+ * Map a linear speed to the motor output that produces it.
+ *
+ * @param 	port 	Motor port.
+ * @param 	speed	Linear speed (-127 to 127).
+ *
+ * @return	Output at nominal voltage.
+ */
+float motorLinearize(tMotor port, short speed) {
 	if (speed == 0) {
-		return 0;
+		return 0.0;
 	}
 	short x = abs(speed);
 
@@ -13,21 +103,29 @@ void motorSetLinear(tMotor port, short speed) {
 		x = 127;
 	}
 	if (port == port1 || port == port10) {
-		motor[port] = sgn(speed) * ((((0.000001115136722 * x
+		return sgn(speed) * ((((0.000001115136722 * x
 				- 0.0001834554708) * x + 0.01010261354) * x + 0.01924469053) * x
 				+ 11.46841392);
 	} else {
-		motor[port] = sgn(speed) * ((((0.000001115136722 * x
+		return sgn(speed) * ((((0.000001115136722 * x
 				- 0.0001834554708) * x + 0.01010261354) * x + 0.01924469053) * x
 				+ 11.46841392);
 	}
 }
 
-void motorSetRpm(tMotor port, float rpm) {
+/**
+ * Map an rpm to the motor output that produces it.
+ *
+ * @param 	port	Motor port.
+ * @param 	rpm 	Target rpm.
+ *
+ * @return	Output at nominal voltage.
+ */
+float motorRpmToOutput(tMotor port, float rpm) {
 	if (rpm == 0) {
-		return 0;
+		return 0.0;
 	}
-	float speed;
+	float speed = 0.0;
 	short x = abs(rpm);
 
 	if (x > 127) {
@@ -41,7 +139,17 @@ void motorSetRpm(tMotor port, float rpm) {
 				- 0.02878725354) * x + 1.899167243) * x - 72.91809714) * x
 				+ 1498.924934) * x - 12721.41815) * x + 94754.80994;
 	}
-	motor[port] = sgn(rpm) * speed / nAvgBatteryLevel;
+	// The fit is in output * mV, so dividing by the nominal level gives the
+	// output at nominal voltage.
+	return sgn(rpm) * speed / MOTOR_NOMINAL_BATTERY_LEVEL;
+}
+
+void motorSetLinear(tMotor port, short speed) {
+	motorSetCompensated(port, motorLinearize(port, speed));
+}
+
+void motorSetRpm(tMotor port, float rpm) {
+	motorSetCompensated(port, motorRpmToOutput(port, rpm));
 }
 
 #endif  // MOTOR_C_
@@ -0,0 +1,223 @@
+#pragma systemFile
+
+#if !defined(MOTORBUFFER_C_)
+#define MOTORBUFFER_C_
+
+#define MOTORBUFFER_NUM_PORTS	10
+
+#include "../util/math.c"
+#include "../util/string.c"
+#include "./motor.c"
+
+typedef struct {
+	float staged[MOTORBUFFER_NUM_PORTS];  // Outputs at nominal voltage.
+	short written[MOTORBUFFER_NUM_PORTS];
+
+	float slewRates[MOTORBUFFER_NUM_PORTS];  // Max change per flush, 0 is unlimited.
+	bool inverted[MOTORBUFFER_NUM_PORTS];
+	short sources[MOTORBUFFER_NUM_PORTS];  // Index of port to mirror, -1 for none.
+	bool managed[MOTORBUFFER_NUM_PORTS];  // Written by flush().
+} MotorBuffer;
+
+MotorBuffer *newMotorBuffer(MotorBuffer *this) {
+	if (this) {
+		for (short i = 0; i < MOTORBUFFER_NUM_PORTS; i++) {
+			this->staged[i] = 0.0;
+			this->written[i] = 0;
+
+			this->slewRates[i] = 0.0;
+			this->inverted[i] = false;
+			this->sources[i] = -1;
+			this->managed[i] = false;
+		}
+	}
+	return this;
+}
+
+short getMotorIndex(tMotor port) {
+	short index = (short)(port - port1);
+
+	return (index >= 0 && index < MOTORBUFFER_NUM_PORTS) ? index : -1;
+}
+
+/**
+ * Have flush() write a port. Staging, mirroring, inverting or setting a slew
+ * rate on a port claims it too; other ports are left to code that writes
+ * motor[] directly.
+ */
+void claim(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	if (this != NULL && i >= 0) {
+		this->managed[i] = true;
+	}
+}
+
+/**
+ * Stop flush() writing a port. Its last written output stays on the motor.
+ */
+void release(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	if (this != NULL && i >= 0) {
+		this->managed[i] = false;
+	}
+}
+
+bool isClaimed(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	return (this != NULL && i >= 0) ? this->managed[i] : false;
+}
+
+float getSlewRate(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	return (this != NULL && i >= 0) ? this->slewRates[i] : 0.0;
+}
+
+void setSlewRate(MotorBuffer *this, tMotor port, float slewRate) {
+	short i = getMotorIndex(port);
+
+	if (this != NULL && i >= 0) {
+		this->slewRates[i] = fabs(slewRate);
+		this->managed[i] = true;
+	}
+}
+
+bool getInverted(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	return (this != NULL && i >= 0) ? this->inverted[i] : false;
+}
+
+void setInverted(MotorBuffer *this, tMotor port, bool inverted) {
+	short i = getMotorIndex(port);
+
+	if (this != NULL && i >= 0) {
+		this->inverted[i] = inverted;
+		this->managed[i] = true;
+	}
+}
+
+/**
+ * Find the port whose staged output a port follows, through any chain of
+ * mirrors.
+ */
+short getMirrorSource(MotorBuffer *this, short index) {
+	// setMirror() refuses cycles, so a chain is at most one hop per port.
+	for (short hops = 0; hops < MOTORBUFFER_NUM_PORTS
+			&& this->sources[index] >= 0; hops++) {
+		index = this->sources[index];
+	}
+	return index;
+}
+
+/**
+ * Make a port follow the output staged for another port. Inversion and slew
+ * rate are still applied per port. Chains are followed at each flush, so a
+ * port keeps following its source if the source later mirrors another port.
+ *
+ * @param 	this  	Pointer to MotorBuffer struct.
+ * @param 	port  	Port to drive.
+ * @param 	source	Port to mirror, or the port itself to stop mirroring.
+ *
+ * @return	false if source already follows port, which would make a cycle.
+ */
+bool setMirror(MotorBuffer *this, tMotor port, tMotor source) {
+	short i = getMotorIndex(port);
+	short j = getMotorIndex(source);
+
+	if (this == NULL || i < 0 || j < 0) {
+		return false;
+	}
+	if (i != j && getMirrorSource(this, j) == i) {
+		return false;
+	}
+	this->sources[i] = (i == j) ? -1 : j;
+	this->managed[i] = true;
+
+	return true;
+}
+
+/**
+ * Stage an output to be written at the next flush. The last output staged
+ * for a port before the flush wins.
+ *
+ * @param 	this  	Pointer to MotorBuffer struct.
+ * @param 	port  	Motor port.
+ * @param 	output	Output at nominal voltage.
+ */
+void stage(MotorBuffer *this, tMotor port, float output) {
+	short i = getMotorIndex(port);
+
+	if (this != NULL && i >= 0) {
+		this->staged[i] = output;
+		this->managed[i] = true;
+	}
+}
+
+void stageLinear(MotorBuffer *this, tMotor port, short speed) {
+	stage(this, port, motorLinearize(port, speed));
+}
+
+void stageRpm(MotorBuffer *this, tMotor port, float rpm) {
+	stage(this, port, motorRpmToOutput(port, rpm));
+}
+
+float getStaged(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	return (this != NULL && i >= 0) ? this->staged[i] : 0.0;
+}
+
+short getWritten(MotorBuffer *this, tMotor port) {
+	short i = getMotorIndex(port);
+
+	return (this != NULL && i >= 0) ? this->written[i] : 0;
+}
+
+/**
+ * Apply mirroring, inversion, battery compensation and slew rate limits to
+ * the staged outputs, then write every claimed port. Call once per tick.
+ *
+ * @param 	this	Pointer to MotorBuffer struct.
+ */
+void flush(MotorBuffer *this) {
+	if (this == NULL) {
+		return;
+	}
+	short outputs[MOTORBUFFER_NUM_PORTS];
+
+	for (short i = 0; i < MOTORBUFFER_NUM_PORTS; i++) {
+		float output = this->staged[getMirrorSource(this, i)];
+
+		if (this->inverted[i]) {
+			output = -output;
+		}
+		output = motorCompensate(output);
+
+		float slewRate = this->slewRates[i];
+		if (slewRate > 0.0) {
+			output = this->written[i] + limit(output - this->written[i], slewRate);
+		}
+		outputs[i] = (short)output;
+	}
+	for (short i = 0; i < MOTORBUFFER_NUM_PORTS; i++) {
+		if (this->managed[i]) {
+			motor[(tMotor)(port1 + i)] = this->written[i] = outputs[i];
+		}
+	}
+}
+
+void print(MotorBuffer *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < MOTORBUFFER_NUM_PORTS; i++) {
+		writeDebugStream("%s: staged=%f; written=%d\n",
+				toString((tMotor)(port1 + i)), this->staged[i], this->written[i]);
+	}
+}
+
+#endif  // MOTORBUFFER_C_
@@ -0,0 +1,215 @@
+#pragma systemFile
+
+#if !defined(MOTORTHERMAL_C_)
+#define MOTORTHERMAL_C_
+
+// 393 motor electrical parameters at the nominal battery level.
+#define MOTORTHERMAL_RESISTANCE      	1.5   // Ohms, 7.2V / 4.8A stall current.
+#define MOTORTHERMAL_FREE_CURRENT    	0.37  // A.
+
+// HR16-400 PTC trip curve: never trips at the hold current, trips in
+// TRIP_TIME at TRIP_CURRENT from ambient. The trip time is the fast end of
+// the curve, so the model heats no slower than a real PTC.
+#define MOTORTHERMAL_HOLD_CURRENT    	1.0     // A.
+#define MOTORTHERMAL_TRIP_CURRENT    	5.0     // A.
+#define MOTORTHERMAL_TRIP_TIME       	1700.0  // ms.
+#define MOTORTHERMAL_TRIP_TEMPERATURE	100.0   // C.
+#define MOTORTHERMAL_AMBIENT         	20.0    // C.
+
+#include "../util/math.c"
+#include "../util/string.c"
+#include "./motor.c"
+
+typedef struct {
+	tMotor port;
+	float freeSpeed;  // rpm at nominal battery level.
+
+	float backEmf;   // V/rpm.
+	float heating;   // C/ms/A^2.
+	float cooling;   // 1/ms.
+
+	float limitTemperature;
+
+	float current;
+	float temperature;
+
+	unsigned long time;
+	float dt;
+} MotorThermal;
+
+/**
+ * Initialize motor thermal model.
+ *
+ * @param 	this            	Pointer to MotorThermal struct.
+ * @param 	port            	Motor port.
+ * @param 	freeSpeed       	Free speed of the motor (100 for torque, 160 for
+ *        	                	high speed, 240 for turbo gearing).
+ * @param 	limitTemperature	PTC temperature (C) the limiter holds the
+ *        	                	motor under.
+ *
+ * @return	Pointer to MotorThermal struct.
+ */
+MotorThermal *newMotorThermal(MotorThermal *this, tMotor port, float freeSpeed,
+		float limitTemperature) {
+	if (this) {
+		this->port = port;
+		this->freeSpeed = freeSpeed;
+
+		this->backEmf = (MOTOR_NOMINAL_BATTERY_LEVEL / 1000.0
+				- MOTORTHERMAL_FREE_CURRENT * MOTORTHERMAL_RESISTANCE) / freeSpeed;
+		// First order PTC: at the hold current the steady state is the trip
+		// temperature, and from T = Ta + (Ttrip - Ta) * I^2 / Ihold^2
+		// * (1 - e^(-cooling * t)) the trip point gives the cooling rate.
+		this->cooling = -log(1.0 - pow(MOTORTHERMAL_HOLD_CURRENT
+				/ MOTORTHERMAL_TRIP_CURRENT, 2.0)) / MOTORTHERMAL_TRIP_TIME;
+		this->heating = this->cooling
+				* (MOTORTHERMAL_TRIP_TEMPERATURE - MOTORTHERMAL_AMBIENT)
+				/ (MOTORTHERMAL_HOLD_CURRENT * MOTORTHERMAL_HOLD_CURRENT);
+
+		this->limitTemperature = limitTemperature;
+
+		this->current = 0.0;
+		this->temperature = MOTORTHERMAL_AMBIENT;
+
+		this->time = 0;
+		this->dt = 0.0;
+	}
+	return this;
+}
+
+MotorThermal *newMotorThermal(MotorThermal *this, tMotor port, float freeSpeed) {
+	return newMotorThermal(this, port, freeSpeed,
+			0.9 * MOTORTHERMAL_TRIP_TEMPERATURE);
+}
+
+MotorThermal *newMotorThermal(MotorThermal *this, tMotor port) {
+	return newMotorThermal(this, port, 100.0);
+}
+
+tMotor getPort(MotorThermal *this) {
+	return this ? this->port : (tMotor)-1;
+}
+
+float getCurrent(MotorThermal *this) {
+	return this ? this->current : 0.0;
+}
+
+float getTemperature(MotorThermal *this) {
+	return this ? this->temperature : 0.0;
+}
+
+float getLimitTemperature(MotorThermal *this) {
+	return this ? this->limitTemperature : 0.0;
+}
+
+void setLimitTemperature(MotorThermal *this, float limitTemperature) {
+	if (this) {
+		this->limitTemperature = limitTemperature;
+	}
+}
+
+bool isTripped(MotorThermal *this) {
+	return this ? this->temperature >= MOTORTHERMAL_TRIP_TEMPERATURE : false;
+}
+
+/**
+ * Advance the model by one step.
+ *
+ * @param 	this        	Pointer to MotorThermal struct.
+ * @param 	output      	Commanded output (-127 to 127).
+ * @param 	rpm         	Measured motor speed.
+ * @param 	batteryLevel	Battery voltage (mV).
+ * @param 	dt          	Time step (ms).
+ */
+void update(MotorThermal *this, float output, float rpm, float batteryLevel,
+		float dt) {
+	if (this == NULL) {
+		return;
+	}
+	float voltage = output / MOTOR_MAX_OUTPUT * batteryLevel / 1000.0;
+	float current = (voltage - this->backEmf * rpm) / MOTORTHERMAL_RESISTANCE;
+
+	// The controller can only drive current in the direction of the output.
+	if (current * output < 0.0) {
+		current = 0.0;
+	}
+	this->current = current;
+	this->temperature += (current * current * this->heating
+			- (this->temperature - MOTORTHERMAL_AMBIENT) * this->cooling) * dt;
+	if (this->temperature < MOTORTHERMAL_AMBIENT) {
+		this->temperature = MOTORTHERMAL_AMBIENT;
+	}
+	this->dt = dt;
+}
+
+/**
+ * Advance the model using the port's current output and the filtered
+ * battery level. Call once per scheduler tick.
+ *
+ * @param 	this	Pointer to MotorThermal struct.
+ * @param 	rpm 	Measured motor speed.
+ */
+void update(MotorThermal *this, float rpm) {
+	if (this == NULL) {
+		return;
+	}
+	if (this->time == 0) {
+		this->time = nSysTime;
+
+		return;
+	}
+	unsigned long dt = nSysTime - this->time;
+
+	update(this, motor[this->port], rpm, motorGetBatteryLevel(), dt);
+
+	this->time += dt;
+}
+
+/**
+ * Limit an output so the modelled PTC stays under the limit temperature
+ * over the next step.
+ *
+ * @param 	this        	Pointer to MotorThermal struct.
+ * @param 	output      	Requested output (-127 to 127).
+ * @param 	rpm         	Measured motor speed.
+ * @param 	batteryLevel	Battery voltage (mV).
+ *
+ * @return	Limited output.
+ */
+float limitOutput(MotorThermal *this, float output, float rpm,
+		float batteryLevel) {
+	if (this == NULL || output == 0.0 || batteryLevel <= 0.0) {
+		return output;
+	}
+	float dt = (this->dt > 0.0) ? this->dt : 1.0;
+	// Largest I^2 that keeps the next temperature at or below the limit.
+	float maxSquared = ((this->limitTemperature - this->temperature) / dt
+			+ (this->temperature - MOTORTHERMAL_AMBIENT) * this->cooling)
+			/ this->heating;
+	float maxCurrent = (maxSquared > 0.0) ? sqrt(maxSquared) : 0.0;
+	// Back EMF in the direction of the output helps, against it hurts.
+	float maxVoltage = sgn(output) * this->backEmf * rpm
+			+ MOTORTHERMAL_RESISTANCE * maxCurrent;
+	float maxOutput = maxVoltage * 1000.0 / batteryLevel * MOTOR_MAX_OUTPUT;
+
+	if (maxOutput < 0.0) {
+		maxOutput = 0.0;
+	}
+	return (fabs(output) > maxOutput) ? sgn(output) * maxOutput : output;
+}
+
+float limitOutput(MotorThermal *this, float output, float rpm) {
+	return limitOutput(this, output, rpm, motorGetBatteryLevel());
+}
+
+void print(MotorThermal *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Port: %s\n", toString(this->port));
+	writeDebugStream("Current: %f\n", this->current);
+	writeDebugStream("Temperature: %f\n", this->temperature);
+	writeDebugStream("Limit Temperature: %f\n", this->limitTemperature);
+}
+
+#endif  // MOTORTHERMAL_C_
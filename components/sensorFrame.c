@@ -0,0 +1,220 @@
+#pragma systemFile
+
+#if !defined(SENSORFRAME_C_)
+#define SENSORFRAME_C_
+
+#define SENSORFRAME_NUM_PORTS 	28  // in1-in8, dgtl1-dgtl12, I2C_1-I2C_8.
+#define SENSORFRAME_NUM_ANALOG	8
+
+#include "../util/string.c"
+
+// Every registered port read once per tick, with the time of the reading,
+// so that everything updated from the frame sees the same instant.
+//
+// Analog ports in high-rate mode are also sampled by sampleHighRate(),
+// called from a faster task, and the frame holds the average of those
+// samples since the last frame. This replaces burst averaging in each
+// gyro's update().
+//
+// A port read from the frame before it was registered is registered then,
+// so a consumer never sees a 0 it would take for a real reading. Until the
+// next update() its value is from the time of that read, not getTime(), so
+// each late registration is logged and counted; register ports up front.
+//
+// Each read holds the frame's semaphore, so a value and its frame match. A
+// consumer that reads several ports (EncoderBank, GyroArray, Navigator)
+// only sees them from one frame if it runs in the same task as update().
+typedef struct {
+	bool registered[SENSORFRAME_NUM_PORTS];
+	bool highRate[SENSORFRAME_NUM_ANALOG];
+
+	long sums[SENSORFRAME_NUM_ANALOG];
+	short counts[SENSORFRAME_NUM_ANALOG];
+
+	unsigned long time;
+	long values[SENSORFRAME_NUM_PORTS];
+	float analogValues[SENSORFRAME_NUM_ANALOG];  // Averaged in high-rate mode.
+
+	short lateRegistrations;
+
+	TSemaphore sem;
+} SensorFrame;
+
+SensorFrame *newSensorFrame(SensorFrame *this) {
+	if (this) {
+		for (short i = 0; i < SENSORFRAME_NUM_PORTS; i++) {
+			this->registered[i] = false;
+			this->values[i] = 0;
+		}
+		for (short i = 0; i < SENSORFRAME_NUM_ANALOG; i++) {
+			this->highRate[i] = false;
+			this->sums[i] = 0;
+			this->counts[i] = 0;
+			this->analogValues[i] = 0.0;
+		}
+		this->time = 0;
+		this->lateRegistrations = 0;
+
+		semaphoreInitialize(this->sem);
+	}
+	return this;
+}
+
+bool isAnalogPort(tSensors port) {
+	return port >= in1 && port < in1 + SENSORFRAME_NUM_ANALOG;
+}
+
+/**
+ * Read a port in every frame.
+ */
+void registerPort(SensorFrame *this, tSensors port) {
+	if (this && port >= 0 && port < SENSORFRAME_NUM_PORTS) {
+		this->registered[port] = true;
+	}
+}
+
+/**
+ * Read an analog port in every frame, and also in sampleHighRate() if
+ * highRate is true.
+ */
+void registerPort(SensorFrame *this, tSensors port, bool highRate) {
+	registerPort(this, port);
+	if (this && isAnalogPort(port)) {
+		this->highRate[port - in1] = highRate;
+	}
+}
+
+/**
+ * Add a sample of every high-rate analog port. Call from a task that runs
+ * faster than the frame is updated, e.g. every 1 ms.
+ */
+void sampleHighRate(SensorFrame *this) {
+	if (this == NULL) {
+		return;
+	}
+	semaphoreLock(this->sem);
+
+	for (short i = 0; i < SENSORFRAME_NUM_ANALOG; i++) {
+		if (this->highRate[i]) {
+			this->sums[i] += SensorValue[(tSensors)(in1 + i)];
+			this->counts[i]++;
+		}
+	}
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
+}
+
+/**
+ * Read every registered port and timestamp the frame. Call once per tick,
+ * before the updates that use the frame.
+ *
+ * @param 	this	Pointer to SensorFrame struct.
+ */
+void update(SensorFrame *this) {
+	if (this == NULL) {
+		return;
+	}
+	semaphoreLock(this->sem);
+
+	this->time = nSysTime;
+	for (short i = 0; i < SENSORFRAME_NUM_PORTS; i++) {
+		if (this->registered[i]) {
+			this->values[i] = SensorValue[(tSensors)i];
+		}
+	}
+	for (short i = 0; i < SENSORFRAME_NUM_ANALOG; i++) {
+		if (this->highRate[i] && this->counts[i] > 0) {
+			this->analogValues[i] = (float)this->sums[i] / this->counts[i];
+			this->sums[i] = 0;
+			this->counts[i] = 0;
+		} else {
+			this->analogValues[i] = this->values[in1 + i];
+		}
+	}
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
+}
+
+unsigned long getTime(SensorFrame *this) {
+	return this ? this->time : 0;
+}
+
+/**
+ * Get the number of ports registered by a read rather than registerPort().
+ */
+short getLateRegistrations(SensorFrame *this) {
+	return this ? this->lateRegistrations : 0;
+}
+
+/**
+ * Register a port on its first read and read it into the current frame.
+ * Call with the semaphore held.
+ */
+void registerLate(SensorFrame *this, tSensors port) {
+	this->registered[port] = true;
+	this->values[port] = SensorValue[port];
+	if (isAnalogPort(port)) {
+		this->analogValues[port - in1] = this->values[port];
+	}
+	this->lateRegistrations++;
+	writeDebugStream("SensorFrame: %s read before registerPort(), read at %d "
+			"instead of the frame time\n", toString(port), nSysTime);
+}
+
+/**
+ * Get a port's value in the frame. An unregistered port is registered and
+ * read now.
+ */
+long getValue(SensorFrame *this, tSensors port) {
+	if (this == NULL || port < 0 || port >= SENSORFRAME_NUM_PORTS) {
+		return 0;
+	}
+	semaphoreLock(this->sem);
+
+	if (!this->registered[port]) {
+		registerLate(this, port);
+	}
+	long value = this->values[port];
+
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
+	return value;
+}
+
+/**
+ * Get an analog port's value in the frame, averaged in high-rate mode. An
+ * unregistered port is registered and read now.
+ */
+float getAnalog(SensorFrame *this, tSensors port) {
+	if (this == NULL || !isAnalogPort(port)) {
+		return 0.0;
+	}
+	semaphoreLock(this->sem);
+
+	if (!this->registered[port]) {
+		registerLate(this, port);
+	}
+	float value = this->analogValues[port - in1];
+
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
+	return value;
+}
+
+void print(SensorFrame *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Time: %d\n", this->time);
+	for (short i = 0; i < SENSORFRAME_NUM_PORTS; i++) {
+		if (this->registered[i]) {
+			writeDebugStream("%d: %d\n", i, this->values[i]);
+		}
+	}
+}
+
+#endif  // SENSORFRAME_C_
@@ -3,6 +3,7 @@
 #if !defined(GYRO_C_)
 #define GYRO_C_
 
+#include "../components/sensorFrame.c"
 #include "../util/math.c"
 #include "../util/string.c"
 
@@ -128,17 +129,24 @@ void calibrate(Gyro *this) {
 	calibrate(this, 1000, 1);
 }
 
-void update(Gyro *this) {
+/**
+ * Integrate a reading.
+ *
+ * @param 	this 	Pointer to Gyro struct.
+ * @param 	value	Analog reading.
+ * @param 	time 	Time of the reading (ms).
+ */
+void update(Gyro *this, float value, unsigned long time) {
 	if (this == NULL) {
 		return;
 	}
 	if (this->time == 0) {
-		this->time = nSysTime;
+		this->time = time;
 
 		return;
 	}
-	unsigned long dt = nSysTime - this->time;
-	float da = getAvgAnalog(this->port, this->burstSize) - this->bias;//SensorValue[this->port] - this->bias;
+	unsigned long dt = time - this->time;
+	float da = value - this->bias;
 
 	if (fabs(da) > this->deadzone) {
 		semaphoreLock(this->sem);
@@ -152,6 +160,22 @@ void update(Gyro *this) {
 	this->time += dt;
 }
 
+void update(Gyro *this) {
+	if (this) {
+		update(this, getAvgAnalog(this->port, this->burstSize), nSysTime);
+	}
+}
+
+/**
+ * Integrate the reading in a sensor frame. Register the port in high-rate
+ * mode to average samples between frames.
+ */
+void update(Gyro *this, SensorFrame *frame) {
+	if (this && frame) {
+		update(this, getAnalog(frame, this->port), getTime(frame));
+	}
+}
+
 void print(Gyro *this) {
 	if (this == NULL) {
 		return;
@@ -4,6 +4,7 @@
 #define GYROARRAY_C_
 
 #include "./gyro.c"
+#include "../components/sensorFrame.c"
 #include "../util/math.c"
 #include "../util/string.c"
 
@@ -145,20 +146,27 @@ void calibrate(GyroArray *this) {
 	calibrate(this, 1000, 1);
 }
 
-void update(GyroArray *this) {
+/**
+ * Integrate a reading from each gyro.
+ *
+ * @param 	this  	Pointer to GyroArray struct.
+ * @param 	values	Analog readings, in port order.
+ * @param 	time  	Time of the readings (ms).
+ */
+void update(GyroArray *this, float *values, unsigned long time) {
 	if (this == NULL) {
 		return;
 	}
 	if (this->time == 0) {
-		this->time = nSysTime;
+		this->time = time;
 
 		return;
 	}
-	unsigned long dt = nSysTime - this->time;
+	unsigned long dt = time - this->time;
 	float das[NUM_ANALOG_PORTS];
 	float sum = 0.0;
 	for (unsigned short i = 0; i < this->size; i++) {
-		sum += das[i] = SensorValue[this->ports[i]] - this->biases[i];
+		sum += das[i] = values[i] - this->biases[i];
 	}
 	float diff01 = fabs(das[0] - das[1]);
 	float diff12 = fabs(das[1] - das[2]);
@@ -184,6 +192,32 @@ void update(GyroArray *this) {
 	this->time += dt;
 }
 
+void update(GyroArray *this) {
+	if (this == NULL) {
+		return;
+	}
+	float values[NUM_ANALOG_PORTS];
+	for (unsigned short i = 0; i < this->size; i++) {
+		values[i] = SensorValue[this->ports[i]];
+	}
+	update(this, values, nSysTime);
+}
+
+/**
+ * Integrate the readings in a sensor frame, so every gyro is sampled at the
+ * same instant.
+ */
+void update(GyroArray *this, SensorFrame *frame) {
+	if (this == NULL || frame == NULL) {
+		return;
+	}
+	float values[NUM_ANALOG_PORTS];
+	for (unsigned short i = 0; i < this->size; i++) {
+		values[i] = getAnalog(frame, this->ports[i]);
+	}
+	update(this, values, getTime(frame));
+}
+
 void print(GyroArray *this) {
 	if (this == NULL) {
 		return;
@@ -0,0 +1,138 @@
+#pragma systemFile
+
+#if !defined(MULTIAXISPROFILE_C_)
+#define MULTIAXISPROFILE_C_
+
+#define MULTIAXISPROFILE_MAX_AXES	4
+
+#include "../util/math.c"
+#include "./trapezoidalProfile.c"
+
+// Trapezoidal profiles for several axes, moving from rest to rest, that all
+// finish at the same time.
+typedef struct {
+	short axes;
+	TrapezoidalProfile profiles[MULTIAXISPROFILE_MAX_AXES];
+	float duration;
+} MultiAxisProfile;
+
+MultiAxisProfile *newMultiAxisProfile(MultiAxisProfile *this) {
+	if (this) {
+		this->axes = 0;
+		this->duration = 0.0;
+	}
+	return this;
+}
+
+/**
+ * Add an axis with its own limits.
+ *
+ * @param 	this  	Pointer to MultiAxisProfile struct.
+ * @param 	maxVel	Maximum velocity of the axis.
+ * @param 	maxAcc	Maximum acceleration of the axis.
+ *
+ * @return	Index of the axis, or -1 if there is no room.
+ */
+short addAxis(MultiAxisProfile *this, float maxVel, float maxAcc) {
+	if (this == NULL || this->axes >= MULTIAXISPROFILE_MAX_AXES) {
+		return -1;
+	}
+	newTrapezoidalProfile(&this->profiles[this->axes], maxVel, maxAcc, 0.0, 0.0);
+
+	return this->axes++;
+}
+
+short getAxes(MultiAxisProfile *this) {
+	return this ? this->axes : 0;
+}
+
+TrapezoidalProfile *getProfile(MultiAxisProfile *this, short axis) {
+	return (this != NULL && axis >= 0 && axis < this->axes)
+			? &this->profiles[axis] : NULL;
+}
+
+/**
+ * Plan every axis, then slow the faster axes so that all of them finish with
+ * the slowest one. A slowed axis keeps its maxAcc and cruises at
+ * v = (a*T - sqrt(a^2*T^2 - 4*a*d)) / 2, from T = d/v + v/a.
+ *
+ * @param 	this     	Pointer to MultiAxisProfile struct.
+ * @param 	distances	Distance to move on each axis (may be negative).
+ *
+ * @return	Common duration of the move.
+ */
+float plan(MultiAxisProfile *this, const float *distances) {
+	if (this == NULL || distances == NULL) {
+		return 0.0;
+	}
+	this->duration = 0.0;
+	for (short i = 0; i < this->axes; i++) {
+		this->duration = max(this->duration, plan(&this->profiles[i], distances[i]));
+	}
+	for (short i = 0; i < this->axes; i++) {
+		TrapezoidalProfile *profile = &this->profiles[i];
+
+		if (getDuration(profile) >= this->duration) {
+			continue;
+		}
+		float a = profile->maxAcc;
+		float d = fabs(distances[i]);
+		float t = this->duration;
+		float maxVel = profile->maxVel;
+
+		profile->maxVel = min((a * t - sqrt(max(a * a * t * t - 4.0 * a * d, 0.0)))
+				/ 2.0, maxVel);
+		plan(profile, distances[i]);
+		profile->maxVel = maxVel;
+	}
+	return this->duration;
+}
+
+float getDuration(MultiAxisProfile *this) {
+	return this ? this->duration : 0.0;
+}
+
+float getPosition(MultiAxisProfile *this, short axis, float t) {
+	return getPosition(getProfile(this, axis), t);
+}
+
+float getVelocity(MultiAxisProfile *this, short axis, float t) {
+	return getVelocity(getProfile(this, axis), t);
+}
+
+float getAcceleration(MultiAxisProfile *this, short axis, float t) {
+	return getAcceleration(getProfile(this, axis), t);
+}
+
+/**
+ * Sample every axis at one time.
+ *
+ * @param 	this      	Pointer to MultiAxisProfile struct.
+ * @param 	t         	Time since the start of the move.
+ * @param 	positions 	Array to store each axis's position in.
+ * @param 	velocities	Array to store each axis's velocity in.
+ */
+void sample(MultiAxisProfile *this, float t, float *positions,
+		float *velocities) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->axes; i++) {
+		positions[i] = getPosition(&this->profiles[i], t);
+		velocities[i] = getVelocity(&this->profiles[i], t);
+	}
+}
+
+void print(MultiAxisProfile *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Duration: %f\n", this->duration);
+	for (short i = 0; i < this->axes; i++) {
+		writeDebugStream("Axis %d: distance=%f; maxVel=%f; maxAcc=%f\n", i,
+				getPosition(&this->profiles[i], this->duration),
+				this->profiles[i].maxVel, this->profiles[i].maxAcc);
+	}
+}
+
+#endif  // MULTIAXISPROFILE_C_
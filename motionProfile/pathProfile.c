@@ -0,0 +1,227 @@
+#pragma systemFile
+
+#if !defined(PATHPROFILE_C_)
+#define PATHPROFILE_C_
+
+#define PATHPROFILE_MAX_POINTS	64
+
+#include "../util/math.c"
+#include "../trajectory/path.c"
+
+// Time-optimal velocity along a path, sampled at evenly spaced distances.
+typedef struct {
+	float maxVel;
+	float maxAcc;
+	float maxWheelVel;
+	float driveWidth;
+
+	short size;
+	float step;  // Distance between points.
+	float velocities[PATHPROFILE_MAX_POINTS];
+	float times[PATHPROFILE_MAX_POINTS];
+} PathProfile;
+
+PathProfile *newPathProfile(PathProfile *this, float maxVel, float maxAcc,
+		float maxWheelVel, float driveWidth) {
+	if (this) {
+		this->maxVel = maxVel;
+		this->maxAcc = maxAcc;
+		this->maxWheelVel = maxWheelVel;
+		this->driveWidth = driveWidth;
+
+		this->size = 0;
+		this->step = 0.0;
+	}
+	return this;
+}
+
+float getMaxVel(PathProfile *this) {
+	return this ? this->maxVel : 0.0;
+}
+
+void setMaxVel(PathProfile *this, float maxVel) {
+	if (this) {
+		this->maxVel = maxVel;
+	}
+}
+
+float getMaxAcc(PathProfile *this) {
+	return this ? this->maxAcc : 0.0;
+}
+
+void setMaxAcc(PathProfile *this, float maxAcc) {
+	if (this) {
+		this->maxAcc = maxAcc;
+	}
+}
+
+float getMaxWheelVel(PathProfile *this) {
+	return this ? this->maxWheelVel : 0.0;
+}
+
+void setMaxWheelVel(PathProfile *this, float maxWheelVel) {
+	if (this) {
+		this->maxWheelVel = maxWheelVel;
+	}
+}
+
+float getDriveWidth(PathProfile *this) {
+	return this ? this->driveWidth : 0.0;
+}
+
+void setDriveWidth(PathProfile *this, float driveWidth) {
+	if (this) {
+		this->driveWidth = driveWidth;
+	}
+}
+
+/**
+ * Plan velocities along a path. Each point is first limited by maxVel and
+ * by the speed at which the outer wheel reaches maxWheelVel on that point's
+ * curvature, then a forward pass applies maxAcc from v0 and a backward pass
+ * applies it into v1.
+ *
+ * @param 	this	Pointer to PathProfile struct.
+ * @param 	path	Path to plan along.
+ * @param 	v0  	Starting velocity.
+ * @param 	v1  	Ending velocity.
+ * @param 	size	Number of points to sample, at most PATHPROFILE_MAX_POINTS.
+ *
+ * @return	Total time to traverse the path.
+ */
+float plan(PathProfile *this, Path *path, float v0, float v1, short size) {
+	if (this == NULL || path == NULL || size < 2) {
+		return 0.0;
+	}
+	if (size > PATHPROFILE_MAX_POINTS) {
+		size = PATHPROFILE_MAX_POINTS;
+	}
+	this->size = size;
+	this->step = getLength(path) / (size - 1);
+
+	float halfWidth = this->driveWidth / 2.0;
+	SplinePoint point;
+
+	for (short i = 0; i < size; i++) {
+		getPointAtDistance(path, i * this->step, &point);
+		// Outer wheel speed is v * (1 + |k| * w / 2).
+		this->velocities[i] = min(this->maxVel,
+				this->maxWheelVel / (1.0 + fabs(point.curvature) * halfWidth));
+	}
+	float twoAccStep = 2.0 * this->maxAcc * this->step;
+
+	this->velocities[0] = min(this->velocities[0], v0);
+	for (short i = 1; i < size; i++) {
+		float prev = this->velocities[i - 1];
+		this->velocities[i] = min(this->velocities[i], sqrt(prev * prev + twoAccStep));
+	}
+	this->velocities[size - 1] = min(this->velocities[size - 1], v1);
+	for (short i = size - 2; i >= 0; i--) {
+		float next = this->velocities[i + 1];
+		this->velocities[i] = min(this->velocities[i], sqrt(next * next + twoAccStep));
+	}
+	this->times[0] = 0.0;
+	for (short i = 1; i < size; i++) {
+		float sum = this->velocities[i - 1] + this->velocities[i];
+		// Constant acceleration between points, so average velocity is the mean.
+		this->times[i] = this->times[i - 1] + ((sum > 0.0) ? 2.0 * this->step / sum
+				: 0.0);
+	}
+	return this->times[size - 1];
+}
+
+float getDuration(PathProfile *this) {
+	return (this != NULL && this->size > 0) ? this->times[this->size - 1] : 0.0;
+}
+
+float getLength(PathProfile *this) {
+	return (this != NULL && this->size > 0) ? this->step * (this->size - 1) : 0.0;
+}
+
+/**
+ * Find the interval containing a time.
+ */
+short getInterval(PathProfile *this, float t) {
+	short low = 0;
+	short high = this->size - 1;
+
+	while (high - low > 1) {
+		short mid = (low + high) / 2;
+
+		if (this->times[mid] <= t) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+float getAccelerationInInterval(PathProfile *this, short i) {
+	float v0 = this->velocities[i];
+	float v1 = this->velocities[i + 1];
+
+	return (v1 * v1 - v0 * v0) / (2.0 * this->step);
+}
+
+/**
+ * Sample the profile at a time.
+ *
+ * @param 	this        	Pointer to PathProfile struct.
+ * @param 	t           	Time since the start of the path.
+ * @param 	distance    	Set to distance along the path.
+ * @param 	velocity    	Set to velocity.
+ * @param 	acceleration	Set to acceleration.
+ */
+void sample(PathProfile *this, float t, float *distance, float *velocity,
+		float *acceleration) {
+	if (this == NULL || this->size < 2) {
+		return;
+	}
+	if (t >= getDuration(this)) {
+		*distance = getLength(this);
+		*velocity = this->velocities[this->size - 1];
+		*acceleration = 0.0;
+
+		return;
+	}
+	if (t < 0.0) {
+		t = 0.0;
+	}
+	short i = getInterval(this, t);
+	float dt = t - this->times[i];
+	float a = getAccelerationInInterval(this, i);
+
+	*distance = i * this->step + this->velocities[i] * dt + a * dt * dt / 2.0;
+	*velocity = this->velocities[i] + a * dt;
+	*acceleration = a;
+}
+
+float getVelocityAtDistance(PathProfile *this, float distance) {
+	if (this == NULL || this->size < 2) {
+		return 0.0;
+	}
+	if (distance <= 0.0) {
+		return this->velocities[0];
+	}
+	short i = (short)(distance / this->step);
+
+	if (i >= this->size - 1) {
+		return this->velocities[this->size - 1];
+	}
+	float v0 = this->velocities[i];
+	// v^2 is linear in distance under constant acceleration.
+	return sqrt(v0 * v0 + 2.0 * getAccelerationInInterval(this, i)
+			* (distance - i * this->step));
+}
+
+void print(PathProfile *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Points: %d\n", this->size);
+	writeDebugStream("Length: %f\n", getLength(this));
+	writeDebugStream("Duration: %f\n", getDuration(this));
+}
+
+#endif  // PATHPROFILE_C_
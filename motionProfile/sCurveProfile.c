@@ -0,0 +1,210 @@
+#pragma systemFile
+
+#if !defined(SCURVEPROFILE_C_)
+#define SCURVEPROFILE_C_
+
+#define SCURVEPROFILE_SEGMENTS	7
+
+#include "../util/math.c"
+
+// Jerk-limited profile from rest to rest: jerk up, constant acceleration,
+// jerk down, cruise, and the mirror image to stop. Shares the planned-query
+// interface of TrapezoidalProfile.
+typedef struct {
+	float maxVel;
+	float maxAcc;
+	float maxJerk;
+
+	float endTimes[SCURVEPROFILE_SEGMENTS];
+	float positions[SCURVEPROFILE_SEGMENTS];  // At segment start.
+	float velocities[SCURVEPROFILE_SEGMENTS];  // At segment start.
+	float accelerations[SCURVEPROFILE_SEGMENTS];  // At segment start.
+	float jerks[SCURVEPROFILE_SEGMENTS];
+	bool planned;
+} SCurveProfile;
+
+SCurveProfile *newSCurveProfile(SCurveProfile *this, float maxVel, float maxAcc,
+		float maxJerk) {
+	if (this) {
+		this->maxVel = maxVel;
+		this->maxAcc = maxAcc;
+		this->maxJerk = maxJerk;
+
+		this->planned = false;
+	}
+	return this;
+}
+
+float getMaxVel(SCurveProfile *this) {
+	return this ? this->maxVel : 0.0;
+}
+
+void setMaxVel(SCurveProfile *this, float maxVel) {
+	if (this) {
+		this->maxVel = maxVel;
+	}
+}
+
+float getMaxAcc(SCurveProfile *this) {
+	return this ? this->maxAcc : 0.0;
+}
+
+void setMaxAcc(SCurveProfile *this, float maxAcc) {
+	if (this) {
+		this->maxAcc = maxAcc;
+	}
+}
+
+float getMaxJerk(SCurveProfile *this) {
+	return this ? this->maxJerk : 0.0;
+}
+
+void setMaxJerk(SCurveProfile *this, float maxJerk) {
+	if (this) {
+		this->maxJerk = maxJerk;
+	}
+}
+
+/**
+ * Plan a move from rest to rest, so that position, velocity and acceleration
+ * can be looked up by time in constant time. Short moves that reach neither
+ * maxVel nor maxAcc are solved in closed form like long ones.
+ *
+ * @param 	this    	Pointer to SCurveProfile struct.
+ * @param 	distance	Distance to move (may be negative).
+ *
+ * @return	Total duration of the move.
+ */
+float plan(SCurveProfile *this, float distance) {
+	if (this == NULL || this->maxVel <= 0.0 || this->maxAcc <= 0.0
+			|| this->maxJerk <= 0.0) {
+		return 0.0;
+	}
+	float direction = (distance >= 0.0) ? 1.0 : -1.0;
+	float d = fabs(distance);
+	float v = this->maxVel;
+	float a = this->maxAcc;
+	float j = this->maxJerk;
+	float jerkTime;  // Each jerk segment.
+	float accTime;   // Each constant acceleration segment.
+	float cruiseTime = 0.0;
+
+	// Ramps needed to reach maxVel; maxAcc is only reached if v > a^2 / j.
+	if (v * j < a * a) {
+		jerkTime = sqrt(v / j);
+		accTime = 0.0;
+	} else {
+		jerkTime = a / j;
+		accTime = v / a - jerkTime;
+	}
+	if (d >= v * (2.0 * jerkTime + accTime)) {
+		cruiseTime = (d - v * (2.0 * jerkTime + accTime)) / v;
+	} else {
+		// maxVel not reached. Peak velocity if maxAcc is still reached, from
+		// d = vp * (a / j + vp / a).
+		float vp = (-a * a / j + sqrt(a * a * a * a / (j * j) + 4.0 * a * d)) / 2.0;
+
+		if (vp >= a * a / j) {
+			jerkTime = a / j;
+			accTime = vp / a - jerkTime;
+		} else {
+			// Neither limit reached, from d = 2 * j * jerkTime^3.
+			jerkTime = pow(d / (2.0 * j), 1.0 / 3.0);
+			accTime = 0.0;
+		}
+	}
+	float durations[SCURVEPROFILE_SEGMENTS] = {jerkTime, accTime, jerkTime,
+			cruiseTime, jerkTime, accTime, jerkTime};
+	float jerks[SCURVEPROFILE_SEGMENTS] = {j, 0.0, -j, 0.0, -j, 0.0, j};
+	float t = 0.0;
+	float p = 0.0;
+	float vel = 0.0;
+	float acc = 0.0;
+
+	for (short i = 0; i < SCURVEPROFILE_SEGMENTS; i++) {
+		float dt = durations[i];
+		float jerk = direction * jerks[i];
+
+		this->positions[i] = p;
+		this->velocities[i] = vel;
+		this->accelerations[i] = acc;
+		this->jerks[i] = jerk;
+
+		p += (vel + (acc / 2.0 + jerk * dt / 6.0) * dt) * dt;
+		vel += (acc + jerk * dt / 2.0) * dt;
+		acc += jerk * dt;
+		t += dt;
+		this->endTimes[i] = t;
+	}
+	this->planned = true;
+
+	return t;
+}
+
+float getDuration(SCurveProfile *this) {
+	return (this != NULL && this->planned)
+			? this->endTimes[SCURVEPROFILE_SEGMENTS - 1] : 0.0;
+}
+
+/**
+ * Find the segment containing a time and the time since its start.
+ */
+short getSegment(SCurveProfile *this, float t, float *dt) {
+	short i = 0;
+
+	while (i < SCURVEPROFILE_SEGMENTS - 1 && t >= this->endTimes[i]) {
+		i++;
+	}
+	if (t > this->endTimes[i]) {
+		t = this->endTimes[i];  // Hold the end state.
+	}
+	*dt = t - ((i > 0) ? this->endTimes[i - 1] : 0.0);
+	if (*dt < 0.0) {
+		*dt = 0.0;
+	}
+	return i;
+}
+
+float getPosition(SCurveProfile *this, float t) {
+	if (this == NULL || !this->planned) {
+		return 0.0;
+	}
+	float dt;
+	short i = getSegment(this, t, &dt);
+
+	return this->positions[i] + (this->velocities[i] + (this->accelerations[i]
+			/ 2.0 + this->jerks[i] * dt / 6.0) * dt) * dt;
+}
+
+float getVelocity(SCurveProfile *this, float t) {
+	if (this == NULL || !this->planned) {
+		return 0.0;
+	}
+	float dt;
+	short i = getSegment(this, t, &dt);
+
+	return this->velocities[i] + (this->accelerations[i]
+			+ this->jerks[i] * dt / 2.0) * dt;
+}
+
+float getAcceleration(SCurveProfile *this, float t) {
+	if (this == NULL || !this->planned) {
+		return 0.0;
+	}
+	float dt;
+	short i = getSegment(this, t, &dt);
+
+	return this->accelerations[i] + this->jerks[i] * dt;
+}
+
+void print(SCurveProfile *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Max Vel: %f\n", this->maxVel);
+	writeDebugStream("Max Acc: %f\n", this->maxAcc);
+	writeDebugStream("Max Jerk: %f\n", this->maxJerk);
+	writeDebugStream("Duration: %f\n", getDuration(this));
+}
+
+#endif  // SCURVEPROFILE_C_
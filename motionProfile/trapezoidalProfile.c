@@ -3,12 +3,21 @@
 #if !defined(TRAPEZOIDALPROFILE_C_)
 #define TRAPEZOIDALPROFILE_C_
 
+#define TRAPEZOIDALPROFILE_MAX_SEGMENTS	4
+
 typedef struct {
 	float maxVel;
 	float maxAcc;
 
 	float v0;
 	float v1;
+
+	// Constant acceleration segments from the last plan().
+	short segments;
+	float endTimes[TRAPEZOIDALPROFILE_MAX_SEGMENTS];
+	float positions[TRAPEZOIDALPROFILE_MAX_SEGMENTS];  // At segment start.
+	float velocities[TRAPEZOIDALPROFILE_MAX_SEGMENTS];  // At segment start.
+	float accelerations[TRAPEZOIDALPROFILE_MAX_SEGMENTS];
 } TrapezoidalProfile;
 
 TrapezoidalProfile *newTrapezoidalProfile(TrapezoidalProfile *this, float maxVel,
@@ -19,6 +28,8 @@ TrapezoidalProfile *newTrapezoidalProfile(TrapezoidalProfile *this, float maxVel
 
 		this->v0 = v0;
 		this->v1 = v1;
+
+		this->segments = 0;
 	}
 	return this;
 }
@@ -84,4 +95,163 @@ float update(TrapezoidalProfile *this, float error, float t) {
 	return v;  // Return target velocity.
 }
 
+/**
+ * Append a constant acceleration segment to the plan.
+ */
+void addSegment(TrapezoidalProfile *this, float duration, float velocity,
+		float acceleration) {
+	short i = this->segments;
+	float startTime = 0.0;
+
+	if (i > 0) {
+		float dt = this->endTimes[i - 1] - ((i > 1) ? this->endTimes[i - 2] : 0.0);
+
+		startTime = this->endTimes[i - 1];
+		this->positions[i] = this->positions[i - 1] + (this->velocities[i - 1]
+				+ this->accelerations[i - 1] * dt / 2.0) * dt;
+	}
+	this->endTimes[i] = startTime + duration;
+	this->velocities[i] = velocity;
+	this->accelerations[i] = acceleration;
+	this->segments++;
+}
+
+/**
+ * Plan the segments for a move, given a start position and velocity.
+ */
+void planSegments(TrapezoidalProfile *this, float start, float distance,
+		float v0) {
+	float direction = (distance > 0.0 || (distance == 0.0 && v0 >= 0.0)) ? 1.0
+			: -1.0;
+	// Work in the direction of travel, so distance and speeds are positive.
+	float d = fabs(distance);
+	float a = this->maxAcc;
+	float u0 = direction * v0;
+	float u1 = min(fabs(this->v1), this->maxVel);
+
+	this->segments = 0;
+	this->positions[0] = start;
+
+	// End speed unreachable within d, so end as fast as possible instead.
+	if (u1 * u1 > 2.0 * a * d + u0 * u0) {
+		u1 = sqrt(2.0 * a * d + u0 * u0);
+	}
+	if (u0 > 0.0 && u0 * u0 - u1 * u1 > 2.0 * a * d) {
+		// Cannot slow down to u1 in time; stop past the goal, then come back to
+		// it and stop there.
+		addSegment(this, u0 / a, direction * u0, -direction * a);
+		direction = -direction;
+		d = u0 * u0 / (2.0 * a) - d;
+		u0 = 0.0;
+		u1 = 0.0;
+	}
+	// Peak of a triangular profile, capped at maxVel for a trapezoid.
+	float vp = min(sqrt(a * d + (u0 * u0 + u1 * u1) / 2.0), this->maxVel);
+	float a1 = (vp >= u0) ? a : -a;
+	float d1 = (vp * vp - u0 * u0) / (2.0 * a1);
+	float d3 = (vp * vp - u1 * u1) / (2.0 * a);
+	float d2 = max(d - d1 - d3, 0.0);
+
+	addSegment(this, (vp - u0) / a1, direction * u0, direction * a1);
+	addSegment(this, (vp > 0.0) ? d2 / vp : 0.0, direction * vp, 0.0);
+	addSegment(this, (vp - u1) / a, direction * vp, -direction * a);
+}
+
+/**
+ * Plan a move from rest at position 0 (or from v0), so that position,
+ * velocity and acceleration can be looked up by time in constant time. Uses
+ * maxVel, maxAcc, v0 and v1, and handles moves in either direction and moves
+ * too short to reach maxVel.
+ *
+ * @param 	this    	Pointer to TrapezoidalProfile struct.
+ * @param 	distance	Distance to move (may be negative).
+ *
+ * @return	Total duration of the move.
+ */
+float plan(TrapezoidalProfile *this, float distance) {
+	if (this == NULL || this->maxAcc <= 0.0) {
+		return 0.0;
+	}
+	planSegments(this, 0.0, distance, this->v0);
+
+	return this->endTimes[this->segments - 1];
+}
+
+/**
+ * Plan a new move from the current state, for when the goal changes during a
+ * move. Position and velocity stay continuous, and time restarts from 0. If
+ * the new goal is too close to stop at, the plan stops past it and comes
+ * back.
+ *
+ * @param 	this    	Pointer to TrapezoidalProfile struct.
+ * @param 	distance	New goal, measured like position.
+ * @param 	position	Current position.
+ * @param 	velocity	Current velocity.
+ *
+ * @return	Duration of the rest of the move.
+ */
+float replan(TrapezoidalProfile *this, float distance, float position,
+		float velocity) {
+	if (this == NULL || this->maxAcc <= 0.0) {
+		return 0.0;
+	}
+	planSegments(this, position, distance - position, velocity);
+
+	return this->endTimes[this->segments - 1];
+}
+
+float getDuration(TrapezoidalProfile *this) {
+	return (this != NULL && this->segments > 0)
+			? this->endTimes[this->segments - 1] : 0.0;
+}
+
+/**
+ * Find the segment containing a time and the time since its start.
+ */
+short getSegment(TrapezoidalProfile *this, float t, float *dt) {
+	short i = 0;
+
+	while (i < this->segments - 1 && t >= this->endTimes[i]) {
+		i++;
+	}
+	if (t > this->endTimes[i]) {
+		t = this->endTimes[i];  // Hold the end state.
+	}
+	*dt = t - ((i > 0) ? this->endTimes[i - 1] : 0.0);
+	if (*dt < 0.0) {
+		*dt = 0.0;
+	}
+	return i;
+}
+
+float getPosition(TrapezoidalProfile *this, float t) {
+	if (this == NULL || this->segments == 0) {
+		return 0.0;
+	}
+	float dt;
+	short i = getSegment(this, t, &dt);
+
+	return this->positions[i] + (this->velocities[i]
+			+ this->accelerations[i] * dt / 2.0) * dt;
+}
+
+float getVelocity(TrapezoidalProfile *this, float t) {
+	if (this == NULL || this->segments == 0) {
+		return 0.0;
+	}
+	float dt;
+	short i = getSegment(this, t, &dt);
+
+	return this->velocities[i] + this->accelerations[i] * dt;
+}
+
+float getAcceleration(TrapezoidalProfile *this, float t) {
+	if (this == NULL || this->segments == 0 || t >= getDuration(this)) {
+		return 0.0;
+	}
+	float dt;
+
+	return this->accelerations[getSegment(this, t, &dt)];
+}
+
 #endif  // TRAPEZOIDALPROFILE_C_
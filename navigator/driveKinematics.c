@@ -0,0 +1,189 @@
+#pragma systemFile
+
+#if !defined(DRIVEKINEMATICS_C_)
+#define DRIVEKINEMATICS_C_
+
+#define DRIVEKINEMATICS_MAX_WHEELS	4
+#define DRIVEKINEMATICS_FORWARD   	0
+#define DRIVEKINEMATICS_STRAFE    	1
+#define DRIVEKINEMATICS_TURN      	2
+
+#include "../util/math.c"
+
+// Wheel order: tank is left, right; H-drive is left, right, middle; X-drive
+// and mecanum are front left, front right, back left, back right.
+typedef enum DriveType {
+	TANK_DRIVE,
+	H_DRIVE,
+	X_DRIVE,
+	MECANUM_DRIVE
+} DriveType;
+
+// Chassis velocity is forward, strafe (to the right, like Navigator's middle
+// encoder) and turn (radians/s, counterclockwise, like Navigator's
+// (right - left) / driveWidth).
+typedef struct {
+	DriveType type;
+	short wheels;
+	float maxWheelVel;
+
+	float inverse[DRIVEKINEMATICS_MAX_WHEELS][3];  // Chassis to wheel.
+	float forward[3][DRIVEKINEMATICS_MAX_WHEELS];  // Wheel to chassis.
+} DriveKinematics;
+
+void setWheel(DriveKinematics *this, short wheel, float forward, float strafe,
+		float turn) {
+	this->inverse[wheel][DRIVEKINEMATICS_FORWARD] = forward;
+	this->inverse[wheel][DRIVEKINEMATICS_STRAFE] = strafe;
+	this->inverse[wheel][DRIVEKINEMATICS_TURN] = turn;
+}
+
+/**
+ * Initialize drive kinematics.
+ *
+ * @param 	this       	Pointer to DriveKinematics struct.
+ * @param 	type       	Drive type.
+ * @param 	trackWidth 	Distance between left and right wheels.
+ * @param 	wheelBase  	Distance between front and back wheels (X-drive and
+ *        	           	mecanum only).
+ * @param 	maxWheelVel	Wheel velocity at full output.
+ *
+ * @return	Pointer to DriveKinematics struct.
+ */
+DriveKinematics *newDriveKinematics(DriveKinematics *this, DriveType type,
+		float trackWidth, float wheelBase, float maxWheelVel) {
+	if (this == NULL) {
+		return NULL;
+	}
+	this->type = type;
+	this->maxWheelVel = maxWheelVel;
+
+	float halfWidth = trackWidth / 2.0;
+
+	if (type == X_DRIVE || type == MECANUM_DRIVE) {
+		// A turn moves a corner wheel at (halfWidth, wheelBase / 2) by halfWidth
+		// forward and wheelBase / 2 sideways per radian. X-drive wheels are at
+		// 45 degrees, so each component counts sqrt(0.5); a mecanum wheel's
+		// rollers count both in full.
+		float roll = (type == X_DRIVE) ? sqrt(0.5) : 1.0;
+		float arm = (halfWidth + wheelBase / 2.0) * roll;
+
+		this->wheels = 4;
+		setWheel(this, 0, roll, roll, -arm);
+		setWheel(this, 1, roll, -roll, arm);
+		setWheel(this, 2, roll, -roll, -arm);
+		setWheel(this, 3, roll, roll, arm);
+	} else {
+		this->wheels = (type == H_DRIVE) ? 3 : 2;
+		setWheel(this, 0, 1.0, 0.0, -halfWidth);
+		setWheel(this, 1, 1.0, 0.0, halfWidth);
+		setWheel(this, 2, 0.0, 1.0, 0.0);
+	}
+	// The columns of inverse are orthogonal for every drive type, so its
+	// pseudoinverse is its transpose with each row divided by its squared norm.
+	for (short j = 0; j < 3; j++) {
+		float norm = 0.0;
+
+		for (short i = 0; i < this->wheels; i++) {
+			norm += this->inverse[i][j] * this->inverse[i][j];
+		}
+		for (short i = 0; i < this->wheels; i++) {
+			this->forward[j][i] = (norm > 0.0) ? this->inverse[i][j] / norm : 0.0;
+		}
+	}
+	return this;
+}
+
+DriveKinematics *newDriveKinematics(DriveKinematics *this, DriveType type,
+		float trackWidth, float maxWheelVel) {
+	return newDriveKinematics(this, type, trackWidth, trackWidth, maxWheelVel);
+}
+
+DriveType getType(DriveKinematics *this) {
+	return this ? this->type : TANK_DRIVE;
+}
+
+short getWheels(DriveKinematics *this) {
+	return this ? this->wheels : 0;
+}
+
+float getMaxWheelVel(DriveKinematics *this) {
+	return this ? this->maxWheelVel : 0.0;
+}
+
+void setMaxWheelVel(DriveKinematics *this, float maxWheelVel) {
+	if (this) {
+		this->maxWheelVel = maxWheelVel;
+	}
+}
+
+/**
+ * Convert a chassis velocity to wheel commands between -1 and 1. If any wheel
+ * would saturate, all of them are scaled down together, which keeps the
+ * direction of motion and trades speed for it.
+ *
+ * @param 	this    	Pointer to DriveKinematics struct.
+ * @param 	forward 	Forward velocity.
+ * @param 	strafe  	Strafe velocity (ignored by tank drives).
+ * @param 	turn    	Turn rate (radians/s).
+ * @param 	commands	Array to store each wheel's command in.
+ */
+void toWheels(DriveKinematics *this, float forward, float strafe, float turn,
+		float *commands) {
+	if (this == NULL || commands == NULL || this->maxWheelVel <= 0.0) {
+		return;
+	}
+	float largest = 1.0;
+
+	for (short i = 0; i < this->wheels; i++) {
+		commands[i] = (this->inverse[i][DRIVEKINEMATICS_FORWARD] * forward
+				+ this->inverse[i][DRIVEKINEMATICS_STRAFE] * strafe
+				+ this->inverse[i][DRIVEKINEMATICS_TURN] * turn) / this->maxWheelVel;
+		largest = max(largest, fabs(commands[i]));
+	}
+	for (short i = 0; i < this->wheels; i++) {
+		commands[i] /= largest;
+	}
+}
+
+/**
+ * Convert wheel velocities to a chassis velocity, by least squares for drives
+ * with more wheels than degrees of freedom.
+ *
+ * @param 	this      	Pointer to DriveKinematics struct.
+ * @param 	velocities	Array of wheel velocities.
+ * @param 	forward   	Set to forward velocity.
+ * @param 	strafe    	Set to strafe velocity.
+ * @param 	turn      	Set to turn rate (radians/s).
+ */
+void toChassis(DriveKinematics *this, const float *velocities, float *forward,
+		float *strafe, float *turn) {
+	if (this == NULL || velocities == NULL) {
+		return;
+	}
+	float chassis[3];
+
+	for (short j = 0; j < 3; j++) {
+		chassis[j] = 0.0;
+		for (short i = 0; i < this->wheels; i++) {
+			chassis[j] += this->forward[j][i] * velocities[i];
+		}
+	}
+	*forward = chassis[DRIVEKINEMATICS_FORWARD];
+	*strafe = chassis[DRIVEKINEMATICS_STRAFE];
+	*turn = chassis[DRIVEKINEMATICS_TURN];
+}
+
+void print(DriveKinematics *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->wheels; i++) {
+		writeDebugStream("Wheel %d: forward=%f; strafe=%f; turn=%f\n", i,
+				this->inverse[i][DRIVEKINEMATICS_FORWARD],
+				this->inverse[i][DRIVEKINEMATICS_STRAFE],
+				this->inverse[i][DRIVEKINEMATICS_TURN]);
+	}
+}
+
+#endif  // DRIVEKINEMATICS_C_
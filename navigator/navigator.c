@@ -3,7 +3,12 @@
 #if !defined(NAVIGATOR_C_)
 #define NAVIGATOR_C_
 
+#define NAVIGATOR_LEFT  	0
+#define NAVIGATOR_RIGHT 	1
+#define NAVIGATOR_MIDDLE	2
+
 #include "../util/math.c"
+#include "../components/encoderBank.c"
 #include "../components/encoderWheel.c"
 
 typedef struct {
@@ -17,9 +22,7 @@ typedef struct {
 	float y;
 	float heading;
 
-	float lastL;
-	float lastR;
-	float lastM;
+	EncoderBank encoders;  // Left, right and middle.
 
 	TSemaphore sem;
 } Navigator;
@@ -38,9 +41,10 @@ Navigator *newNavigator(Navigator *this, EncoderWheel *leftEncoder,
 		this->y = y;
 		this->heading = heading;
 
-		this->lastL = getDistance(leftEncoder);
-		this->lastR = getDistance(rightEncoder);
-		this->lastM = getDistance(middleEncoder);
+		newEncoderBank(&this->encoders);
+		addEncoderWheel(&this->encoders, leftEncoder);
+		addEncoderWheel(&this->encoders, rightEncoder);
+		addEncoderWheel(&this->encoders, middleEncoder);
 
 		semaphoreInitialize(this->sem);
 	}
@@ -80,7 +84,7 @@ void setLeftEncoder(Navigator *this, EncoderWheel *leftEncoder) {
 		semaphoreLock(this->sem);
 
 		this->leftEncoder = leftEncoder;
-		this->lastL = getDistance(leftEncoder);
+		setEncoderWheel(&this->encoders, NAVIGATOR_LEFT, leftEncoder);
 
 		if (bDoesTaskOwnSemaphore(this->sem)) {
 			semaphoreUnlock(this->sem);
@@ -97,7 +101,7 @@ void setRightEncoder(Navigator *this, EncoderWheel *rightEncoder) {
 		semaphoreLock(this->sem);
 
 		this->rightEncoder = rightEncoder;
-		this->lastR = getDistance(rightEncoder);
+		setEncoderWheel(&this->encoders, NAVIGATOR_RIGHT, rightEncoder);
 
 		if (bDoesTaskOwnSemaphore(this->sem)) {
 			semaphoreUnlock(this->sem);
@@ -114,7 +118,7 @@ void setMiddleEncoder(Navigator *this, EncoderWheel *middleEncoder) {
 		semaphoreLock(this->sem);
 
 		this->middleEncoder = middleEncoder;
-		this->lastM = getDistance(middleEncoder);
+		setEncoderWheel(&this->encoders, NAVIGATOR_MIDDLE, middleEncoder);
 
 		if (bDoesTaskOwnSemaphore(this->sem)) {
 			semaphoreUnlock(this->sem);
@@ -180,30 +184,78 @@ void setHeading(Navigator *this, float heading) {
 	}
 }
 
+/**
+ * Integrate the pose from the encoder bank's latest changes.
+ */
+void updatePose(Navigator *this) {
+	float diffL = getDelta(&this->encoders, NAVIGATOR_LEFT);
+	float diffR = getDelta(&this->encoders, NAVIGATOR_RIGHT);
+	float diffM = getDelta(&this->encoders, NAVIGATOR_MIDDLE);
+
+	float diffH = (diffR - diffL) / this->driveWidth;
+	float tempHeading = this->heading + diffH / 2.0;
+	float magnitude = (diffL + diffR) / 2.0;
+
+	this->x += magnitude * sin(tempHeading) + diffM * cos(tempHeading);
+	this->y += magnitude * cos(tempHeading) + diffM * sin(tempHeading);
+	this->heading = boundAngle0To2PiRadians(this->heading + diffH);
+}
+
 void update(Navigator *this) {
 	if (this == NULL) {
 		return;
 	}
 	semaphoreLock(this->sem);
 
-	float diffL = getDistance(this->leftEncoder) - this->lastL;
-	float diffR = getDistance(this->rightEncoder) - this->lastR;
-	float diffM = getDistance(this->middleEncoder) - this->lastM;
+	update(&this->encoders);
+	updatePose(this);
+
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
+}
+
+/**
+ * Update the pose from the encoder counts in a sensor frame.
+ *
+ * @param 	this 	Pointer to Navigator struct.
+ * @param 	frame	Pointer to SensorFrame struct.
+ */
+void update(Navigator *this, SensorFrame *frame) {
+	if (this == NULL || frame == NULL) {
+		return;
+	}
+	semaphoreLock(this->sem);
 
-	this->lastL += diffL;
-	this->lastR += diffR;
-	this->lastM += diffM;
+	update(&this->encoders, frame);
+	updatePose(this);
 
 	if (bDoesTaskOwnSemaphore(this->sem)) {
 		semaphoreUnlock(this->sem);
 	}
-	float diffH = (diffR - diffL) / this->driveWidth;
-	float tempHeading = this->heading + diffH / 2.0;
-	float magnitude = (diffL + diffR) / 2.0;
+}
 
-	this->x += magnitude * sin(tempHeading) + diffM * cos(tempHeading);
-	this->y += magnitude * cos(tempHeading) + diffM * sin(tempHeading);
-	this->heading = boundAngle0To2PiRadians(this->heading + diffH);
+/**
+ * Get x, y and heading from the same update.
+ *
+ * @param 	this   	Pointer to Navigator struct.
+ * @param 	x      	Set to x.
+ * @param 	y      	Set to y.
+ * @param 	heading	Set to heading.
+ */
+void getPose(Navigator *this, float *x, float *y, float *heading) {
+	if (this == NULL) {
+		return;
+	}
+	semaphoreLock(this->sem);
+
+	*x = this->x;
+	*y = this->y;
+	*heading = this->heading;
+
+	if (bDoesTaskOwnSemaphore(this->sem)) {
+		semaphoreUnlock(this->sem);
+	}
 }
 
 void print(Navigator *this) {
@@ -0,0 +1,344 @@
+#pragma systemFile
+
+#if !defined(PATHFOLLOWER_C_)
+#define PATHFOLLOWER_C_
+
+#include "../util/math.c"
+#include "../motionProfile/pathProfile.c"
+#include "../pid/velocityController.c"
+#include "../trajectory/path.c"
+#include "./navigator.c"
+
+typedef enum PathFollowerMode {
+	PURE_PURSUIT,
+	RAMSETE
+} PathFollowerMode;
+
+typedef struct {
+	PathFollowerMode mode;
+
+	Path *path;
+	PathProfile *profile;
+	Navigator *navigator;
+
+	float driveWidth;
+	float lookahead;  // Pure pursuit lookahead distance.
+	float b;          // RAMSETE convergence gain.
+	float zeta;       // RAMSETE damping.
+	float tolerance;  // Distance from the end that counts as finished.
+	float finishVelocity;  // Minimum speed toward the end once the profile ends.
+	float timeout;         // Time allowed after the profile ends (s).
+	float turnSign;   // -1 for Navigator poses, where right wheel ahead is clockwise.
+
+	PathProjection projection;
+	unsigned long startTime;
+
+	float leftVelocity;
+	float rightVelocity;
+	float acceleration;
+	bool finished;
+	bool timedOut;
+} PathFollower;
+
+/**
+ * Initialize path follower.
+ *
+ * @param 	this      	Pointer to PathFollower struct.
+ * @param 	mode      	Steering law.
+ * @param 	path      	Path to follow.
+ * @param 	profile   	Velocity profile planned along path.
+ * @param 	navigator 	Navigator tracking the robot's pose.
+ * @param 	driveWidth	Distance between left and right wheels.
+ *
+ * @return	Pointer to PathFollower struct.
+ */
+PathFollower *newPathFollower(PathFollower *this, PathFollowerMode mode,
+		Path *path, PathProfile *profile, Navigator *navigator, float driveWidth) {
+	if (this) {
+		this->mode = mode;
+
+		this->path = path;
+		this->profile = profile;
+		this->navigator = navigator;
+
+		this->driveWidth = driveWidth;
+		this->lookahead = 12.0;
+		this->b = 2.0 / 144.0;  // 2.0 /ft^2 expressed in /in^2.
+		this->zeta = 0.7;
+		this->tolerance = 1.0;
+		this->finishVelocity = 4.0;
+		this->timeout = 2.0;
+		this->turnSign = 1.0;
+
+		newPathProjection(&this->projection);
+		this->startTime = 0;
+
+		this->leftVelocity = 0.0;
+		this->rightVelocity = 0.0;
+		this->acceleration = 0.0;
+		this->finished = false;
+		this->timedOut = false;
+	}
+	return this;
+}
+
+PathFollowerMode getMode(PathFollower *this) {
+	return this ? this->mode : PURE_PURSUIT;
+}
+
+void setMode(PathFollower *this, PathFollowerMode mode) {
+	if (this) {
+		this->mode = mode;
+	}
+}
+
+float getLookahead(PathFollower *this) {
+	return this ? this->lookahead : 0.0;
+}
+
+void setLookahead(PathFollower *this, float lookahead) {
+	if (this) {
+		this->lookahead = lookahead;
+	}
+}
+
+float getB(PathFollower *this) {
+	return this ? this->b : 0.0;
+}
+
+void setB(PathFollower *this, float b) {
+	if (this) {
+		this->b = b;
+	}
+}
+
+float getZeta(PathFollower *this) {
+	return this ? this->zeta : 0.0;
+}
+
+void setZeta(PathFollower *this, float zeta) {
+	if (this) {
+		this->zeta = zeta;
+	}
+}
+
+float getTolerance(PathFollower *this) {
+	return this ? this->tolerance : 0.0;
+}
+
+void setTolerance(PathFollower *this, float tolerance) {
+	if (this) {
+		this->tolerance = tolerance;
+	}
+}
+
+float getFinishVelocity(PathFollower *this) {
+	return this ? this->finishVelocity : 0.0;
+}
+
+void setFinishVelocity(PathFollower *this, float finishVelocity) {
+	if (this) {
+		this->finishVelocity = finishVelocity;
+	}
+}
+
+float getTimeout(PathFollower *this) {
+	return this ? this->timeout : 0.0;
+}
+
+void setTimeout(PathFollower *this, float timeout) {
+	if (this) {
+		this->timeout = timeout;
+	}
+}
+
+float getLeftVelocity(PathFollower *this) {
+	return this ? this->leftVelocity : 0.0;
+}
+
+float getRightVelocity(PathFollower *this) {
+	return this ? this->rightVelocity : 0.0;
+}
+
+bool isFinished(PathFollower *this) {
+	return this ? this->finished : true;
+}
+
+/**
+ * Get whether the follower gave up short of the end after the timeout.
+ */
+bool isTimedOut(PathFollower *this) {
+	return this ? this->timedOut : false;
+}
+
+PathProjection *getProjection(PathFollower *this) {
+	return this ? &this->projection : NULL;
+}
+
+/**
+ * Start following the path from the beginning of the profile.
+ */
+void start(PathFollower *this) {
+	if (this) {
+		newPathProjection(&this->projection);
+		this->startTime = nSysTime;
+		this->finished = false;
+		this->timedOut = false;
+	}
+}
+
+/**
+ * Set wheel velocities for a forward velocity and turn rate.
+ */
+void setWheelVelocities(PathFollower *this, float velocity, float turnRate) {
+	turnRate *= this->turnSign;
+	this->leftVelocity = velocity - turnRate * this->driveWidth / 2.0;
+	this->rightVelocity = velocity + turnRate * this->driveWidth / 2.0;
+}
+
+void updatePurePursuit(PathFollower *this, float x, float y, float heading,
+		float velocity) {
+	SplinePoint goal;
+	getPointAtDistance(this->path, this->projection.distance + this->lookahead,
+			&goal);
+	float dx = goal.x - x;
+	float dy = goal.y - y;
+	// Lateral offset of the goal in the robot's frame.
+	float lateral = -dx * sin(heading) + dy * cos(heading);
+	float distanceSquared = dx * dx + dy * dy;
+	float curvature = (distanceSquared > 0.0) ? 2.0 * lateral / distanceSquared
+			: 0.0;
+
+	setWheelVelocities(this, velocity, velocity * curvature);
+}
+
+void updateRamsete(PathFollower *this, float x, float y, float heading,
+		float distance, float velocity) {
+	SplinePoint reference;
+	getPointAtDistance(this->path, distance, &reference);
+
+	float dx = reference.x - x;
+	float dy = reference.y - y;
+	float cosHeading = cos(heading);
+	float sinHeading = sin(heading);
+	// Error in the robot's frame.
+	float errorX = cosHeading * dx + sinHeading * dy;
+	float errorY = -sinHeading * dx + cosHeading * dy;
+	float errorHeading = getDifferenceInAngleRadians(heading, reference.heading);
+	float turnRate = velocity * reference.curvature;
+	float k = 2.0 * this->zeta * sqrt(turnRate * turnRate
+			+ this->b * velocity * velocity);
+	float sinc = (fabs(errorHeading) < 0.0001) ? 1.0
+			: sin(errorHeading) / errorHeading;
+
+	setWheelVelocities(this, velocity * cos(errorHeading) + k * errorX,
+			turnRate + k * errorHeading + this->b * velocity * sinc * errorY);
+}
+
+/**
+ * Compute wheel velocity targets from a pose in the waypoint frame.
+ */
+void followPose(PathFollower *this, float t, float x, float y,
+		float heading) {
+	float distance, velocity, acceleration;
+
+	sample(this->profile, t, &distance, &velocity, &acceleration);
+	project(this->path, &this->projection, x, y, heading);
+
+	this->acceleration = acceleration;
+	if (t >= getDuration(this->profile)) {
+		// The profile ends at rest, so a robot short of the end would stop
+		// there. Creep toward the end until it is reached or time runs out.
+		this->finished = this->projection.distance
+				>= getLength(this->path) - this->tolerance;
+		this->timedOut = !this->finished
+				&& t >= getDuration(this->profile) + this->timeout;
+		this->finished = this->finished || this->timedOut;
+		velocity = max(velocity, this->finishVelocity);
+	}
+	if (this->finished) {
+		setWheelVelocities(this, 0.0, 0.0);
+	} else if (this->mode == RAMSETE) {
+		updateRamsete(this, x, y, heading, distance, velocity);
+	} else {
+		updatePurePursuit(this, x, y, heading, velocity);
+	}
+}
+
+/**
+ * Compute wheel velocity targets from a pose, for a drive where the right
+ * wheel moving ahead of the left turns counterclockwise.
+ *
+ * @param 	this   	Pointer to PathFollower struct.
+ * @param 	t      	Time since start (s).
+ * @param 	x      	Robot x.
+ * @param 	y      	Robot y.
+ * @param 	heading	Robot heading (radians, counterclockwise from the x
+ *        	       	axis, like waypoints).
+ */
+void update(PathFollower *this, float t, float x, float y, float heading) {
+	if (this == NULL || this->path == NULL || this->profile == NULL) {
+		return;
+	}
+	this->turnSign = 1.0;
+	followPose(this, t, x, y, heading);
+}
+
+/**
+ * Compute wheel velocity targets from the Navigator's pose.
+ *
+ * @param 	this	Pointer to PathFollower struct.
+ * @param 	t   	Time since start (s).
+ */
+void update(PathFollower *this, float t) {
+	if (this == NULL || this->navigator == NULL || this->path == NULL
+			|| this->profile == NULL) {
+		return;
+	}
+	float x, y, heading;
+	getPose(this->navigator, &x, &y, &heading);
+
+	// Navigator heading is clockwise from the y axis, and rises as the right
+	// wheel gets ahead of the left, so a counterclockwise turn in the
+	// converted frame needs the left wheel faster.
+	this->turnSign = -1.0;
+	followPose(this, t, x, y, boundAngle0To2PiRadians(PI / 2.0 - heading));
+}
+
+/**
+ * Compute wheel velocity targets from the Navigator's pose. Call once per
+ * tick after start().
+ *
+ * @param 	this	Pointer to PathFollower struct.
+ */
+void update(PathFollower *this) {
+	if (this) {
+		update(this, (nSysTime - this->startTime) / 1000.0);
+	}
+}
+
+/**
+ * Pass the wheel velocity targets to the drive's velocity controllers.
+ */
+void setTargets(PathFollower *this, VelocityController *left,
+		VelocityController *right) {
+	if (this == NULL) {
+		return;
+	}
+	setTarget(left, this->leftVelocity, this->finished ? 0.0 : this->acceleration);
+	setTarget(right, this->rightVelocity,
+			this->finished ? 0.0 : this->acceleration);
+}
+
+void print(PathFollower *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Mode: %s\n", (this->mode == RAMSETE) ? "RAMSETE"
+			: "pure pursuit");
+	writeDebugStream("Left: %f; right: %f\n", this->leftVelocity,
+			this->rightVelocity);
+	print(&this->projection);
+}
+
+#endif  // PATHFOLLOWER_C_
@@ -3,16 +3,42 @@
 #if !defined(PID_C_)
 #define PID_C_
 
+#define PID_NO_LIMIT  	1.0e30
+#define PID_MAX_GAINS	8
+
+#include "../util/math.c"
+
 typedef struct {
 	float Kp;
 	float Ki;
 	float Kd;
+	float Kb;  // Back-calculation gain (/ms), or 0 for Ki / Kp.
+
+	float minOutput;
+	float maxOutput;
+	float integralZone;      // Error beyond which the integral is cleared, or 0.
+	float derivativeFilter;  // Derivative filter time constant (ms), or 0.
+
+	// Gain schedule, sorted by scheduling variable.
+	short gains;
+	float scheduleValues[PID_MAX_GAINS];
+	float scheduleKp[PID_MAX_GAINS];
+	float scheduleKi[PID_MAX_GAINS];
+	float scheduleKd[PID_MAX_GAINS];
+
+	float feedforward;  // Added to the output before limiting.
+
+	float settleTolerance;
+	long settleTime;  // Time within tolerance to count as settled (ms).
 
 	float setpoint;
 
 	long time;
-	float integral;
+	float integral;  // Output units.
 	float error;
+	float lastProcessVariable;
+	float derivative;
+	long settleStart;
 
 	float controlVariable;
 
@@ -24,12 +50,28 @@ Pid *newPid(Pid *this, float Kp, float Ki, float Kd, float setpoint) {
 		this->Kp = Kp;
 		this->Ki = Ki;
 		this->Kd = Kd;
+		this->Kb = 0.0;
+
+		this->minOutput = -PID_NO_LIMIT;
+		this->maxOutput = PID_NO_LIMIT;
+		this->integralZone = 0.0;
+		this->derivativeFilter = 0.0;
+
+		this->gains = 0;
+
+		this->feedforward = 0.0;
+
+		this->settleTolerance = 0.0;
+		this->settleTime = 0;
 
 		this->setpoint = setpoint;
 
 		this->time = 0;
 		this->integral = 0.0;
 		this->error = 0.0;
+		this->lastProcessVariable = 0.0;
+		this->derivative = 0.0;
+		this->settleStart = 0;
 
 		this->controlVariable = 0.0;
 
@@ -68,6 +110,154 @@ void setKd(Pid *this, float Kd) {
 	}
 }
 
+float getKb(Pid *this) {
+	return this ? this->Kb : 0.0;
+}
+
+void setKb(Pid *this, float Kb) {
+	if (this) {
+		this->Kb = Kb;
+	}
+}
+
+float getMinOutput(Pid *this) {
+	return this ? this->minOutput : 0.0;
+}
+
+float getMaxOutput(Pid *this) {
+	return this ? this->maxOutput : 0.0;
+}
+
+void setOutputLimits(Pid *this, float minOutput, float maxOutput) {
+	if (this) {
+		this->minOutput = minOutput;
+		this->maxOutput = maxOutput;
+	}
+}
+
+float getIntegralZone(Pid *this) {
+	return this ? this->integralZone : 0.0;
+}
+
+void setIntegralZone(Pid *this, float integralZone) {
+	if (this) {
+		this->integralZone = integralZone;
+	}
+}
+
+float getDerivativeFilter(Pid *this) {
+	return this ? this->derivativeFilter : 0.0;
+}
+
+void setDerivativeFilter(Pid *this, float derivativeFilter) {
+	if (this) {
+		this->derivativeFilter = derivativeFilter;
+	}
+}
+
+float getFeedforward(Pid *this) {
+	return this ? this->feedforward : 0.0;
+}
+
+void setFeedforward(Pid *this, float feedforward) {
+	if (this) {
+		this->feedforward = feedforward;
+	}
+}
+
+/**
+ * Add gains to the schedule, for use at a value of the scheduling variable
+ * (e.g. lift position, speed or battery level).
+ *
+ * @param 	this 	Pointer to Pid struct.
+ * @param 	value	Value of the scheduling variable.
+ * @param 	Kp   	Proportional gain at value.
+ * @param 	Ki   	Integral gain at value.
+ * @param 	Kd   	Derivative gain at value.
+ *
+ * @return	true if the gains were added, false if the schedule is full.
+ */
+bool addGains(Pid *this, float value, float Kp, float Ki, float Kd) {
+	if (this == NULL || this->gains >= PID_MAX_GAINS) {
+		return false;
+	}
+	short i = this->gains;
+
+	// Insert in order.
+	for (; i > 0 && this->scheduleValues[i - 1] > value; i--) {
+		this->scheduleValues[i] = this->scheduleValues[i - 1];
+		this->scheduleKp[i] = this->scheduleKp[i - 1];
+		this->scheduleKi[i] = this->scheduleKi[i - 1];
+		this->scheduleKd[i] = this->scheduleKd[i - 1];
+	}
+	this->scheduleValues[i] = value;
+	this->scheduleKp[i] = Kp;
+	this->scheduleKi[i] = Ki;
+	this->scheduleKd[i] = Kd;
+	this->gains++;
+
+	return true;
+}
+
+void clearGains(Pid *this) {
+	if (this) {
+		this->gains = 0;
+	}
+}
+
+/**
+ * Set Kp, Ki and Kd by linear interpolation in the gain schedule. Outside
+ * the schedule, the gains at the nearest end are used.
+ *
+ * @param 	this 	Pointer to Pid struct.
+ * @param 	value	Value of the scheduling variable.
+ */
+void scheduleGains(Pid *this, float value) {
+	if (this == NULL || this->gains == 0) {
+		return;
+	}
+	short i = 1;
+
+	while (i < this->gains - 1 && this->scheduleValues[i] < value) {
+		i++;
+	}
+	if (this->gains == 1 || value <= this->scheduleValues[0]) {
+		i = 0;
+	} else if (value >= this->scheduleValues[this->gains - 1]) {
+		i = this->gains - 1;
+	} else {
+		float span = this->scheduleValues[i] - this->scheduleValues[i - 1];
+		float f = (span > 0.0) ? (value - this->scheduleValues[i - 1]) / span
+				: 1.0;
+
+		this->Kp = this->scheduleKp[i - 1]
+				+ f * (this->scheduleKp[i] - this->scheduleKp[i - 1]);
+		this->Ki = this->scheduleKi[i - 1]
+				+ f * (this->scheduleKi[i] - this->scheduleKi[i - 1]);
+		this->Kd = this->scheduleKd[i - 1]
+				+ f * (this->scheduleKd[i] - this->scheduleKd[i - 1]);
+
+		return;
+	}
+	this->Kp = this->scheduleKp[i];
+	this->Ki = this->scheduleKi[i];
+	this->Kd = this->scheduleKd[i];
+}
+
+/**
+ * Set when the controller counts as settled.
+ *
+ * @param 	this     	Pointer to Pid struct.
+ * @param 	tolerance	Largest error that counts as at the setpoint.
+ * @param 	time     	Time the error must stay within tolerance (ms).
+ */
+void setSettleCriteria(Pid *this, float tolerance, long time) {
+	if (this) {
+		this->settleTolerance = tolerance;
+		this->settleTime = time;
+	}
+}
+
 float getSetpoint(Pid *this) {
 	return this ? this->setpoint : 0.0;
 }
@@ -78,6 +268,7 @@ void setSetpoint(Pid *this, float setpoint) {
 
 		this->setpoint = setpoint;
 		this->time = 0;
+		this->settleStart = 0;
 
 		if (bDoesTaskOwnSemaphore(this->sem)) {
 			semaphoreUnlock(this->sem);
@@ -85,6 +276,15 @@ void setSetpoint(Pid *this, float setpoint) {
 	}
 }
 
+/**
+ * Whether the error has stayed within the settle tolerance for the settle
+ * time.
+ */
+bool isSettled(Pid *this) {
+	return this != NULL && this->settleStart != 0
+			&& nSysTime - this->settleStart >= this->settleTime;
+}
+
 void update(Pid *this, float processVariable) {
 	if (this == NULL) {
 		return;
@@ -96,21 +296,61 @@ void update(Pid *this, float processVariable) {
 	if (this->time == 0) {
 		this->time = nSysTime;
 		this->error = error;
+		this->lastProcessVariable = processVariable;
+		this->derivative = 0.0;
 	}
 	long dt = nSysTime - this->time;
 
-	this->integral += error * dt;
+	if (this->integralZone > 0.0 && fabs(error) > this->integralZone) {
+		this->integral = 0.0;
+	} else {
+		this->integral += this->Ki * error * dt;
+	}
+	if (dt > 0) {
+		// Derivative on measurement, so setpoint changes do not kick.
+		float derivative = (this->lastProcessVariable - processVariable) / dt;
+
+		this->derivative += dt / (this->derivativeFilter + dt)
+				* (derivative - this->derivative);
+	}
+	float output = this->Kp * error + this->integral + this->Kd * this->derivative
+			+ this->feedforward;
 
-	float derivative = (dt == 0) ? 0.0 : ((error - this->error) / dt);
+	this->controlVariable = max(min(output, this->maxOutput), this->minOutput);
 
-	this->controlVariable = this->Kp * error + this->Ki * this->integral + this->Kd * derivative;
+	// Back-calculation: while saturated, bleed the integral toward the value
+	// that would just reach the limit.
+	if (this->controlVariable != output) {
+		float Kb = (this->Kb > 0.0) ? this->Kb
+				: ((this->Kp != 0.0) ? this->Ki / this->Kp : 0.0);
 
+		this->integral += min(Kb * dt, 1.0) * (this->controlVariable - output);
+	}
+	if (fabs(error) > this->settleTolerance) {
+		this->settleStart = 0;
+	} else if (this->settleStart == 0) {
+		this->settleStart = nSysTime;
+	}
 	this->time += dt;
 	this->error = error;
+	this->lastProcessVariable = processVariable;
 
 	if (bDoesTaskOwnSemaphore(this->sem)) {
 		semaphoreUnlock(this->sem);
 	}
 }
 
+/**
+ * Update with gains from the gain schedule. Since the integral is kept in
+ * output units, a change in Ki does not bump the output.
+ *
+ * @param 	this            	Pointer to Pid struct.
+ * @param 	processVariable 	Measured process variable.
+ * @param 	scheduleVariable	Value of the scheduling variable.
+ */
+void update(Pid *this, float processVariable, float scheduleVariable) {
+	scheduleGains(this, scheduleVariable);
+	update(this, processVariable);
+}
+
 #endif  // PID_C_
@@ -0,0 +1,233 @@
+#pragma systemFile
+
+#if !defined(PIDAUTOTUNER_C_)
+#define PIDAUTOTUNER_C_
+
+#include "../util/math.c"
+#include "./pid.c"
+
+typedef enum PidTuningRule {
+	ZIEGLER_NICHOLS,
+	TYREUS_LUYBEN,    // Less overshoot, slower; suits lifts and arms.
+	PESSEN_INTEGRAL,  // Faster disturbance rejection.
+	SOME_OVERSHOOT,
+	NO_OVERSHOOT
+} PidTuningRule;
+
+// Relay feedback (Astrom-Hagglund) experiment. The output switches between
+// bias + amplitude and bias - amplitude each time the process variable
+// crosses the setpoint, which drives the mechanism into a limit cycle at its
+// ultimate period. The ultimate gain follows from the oscillation's size.
+typedef struct {
+	float setpoint;
+	float bias;
+	float amplitude;   // Relay output step.
+	float hysteresis;  // Noise band around the setpoint.
+	short cycles;      // Oscillations to average.
+	PidTuningRule rule;
+
+	bool high;
+	long cycleStart;  // Time of the last switch high (ms), or -1.
+	short measured;   // Oscillations measured, after one to settle.
+	float maxValue;
+	float minValue;
+	float periodSum;
+	float heightSum;
+
+	float output;
+	bool finished;
+	float Ku;  // Ultimate gain.
+	float Tu;  // Ultimate period (ms).
+} PidAutotuner;
+
+/**
+ * Initialize relay autotuner.
+ *
+ * @param 	this      	Pointer to PidAutotuner struct.
+ * @param 	setpoint  	Process variable to oscillate around.
+ * @param 	bias      	Output that roughly holds the setpoint (e.g. gravity).
+ * @param 	amplitude 	Relay output step above and below bias.
+ * @param 	hysteresis	Band around the setpoint that does not switch the relay.
+ * @param 	cycles    	Oscillations to average.
+ * @param 	rule      	Tuning rule used by applyGains().
+ *
+ * @return	Pointer to PidAutotuner struct.
+ */
+PidAutotuner *newPidAutotuner(PidAutotuner *this, float setpoint, float bias,
+		float amplitude, float hysteresis, short cycles, PidTuningRule rule) {
+	if (this) {
+		this->setpoint = setpoint;
+		this->bias = bias;
+		this->amplitude = amplitude;
+		this->hysteresis = hysteresis;
+		this->cycles = cycles;
+		this->rule = rule;
+
+		this->high = true;
+		this->cycleStart = -1;
+		this->measured = -1;
+		this->maxValue = setpoint;
+		this->minValue = setpoint;
+		this->periodSum = 0.0;
+		this->heightSum = 0.0;
+
+		this->output = bias + amplitude;
+		this->finished = false;
+		this->Ku = 0.0;
+		this->Tu = 0.0;
+	}
+	return this;
+}
+
+PidAutotuner *newPidAutotuner(PidAutotuner *this, float setpoint,
+		float amplitude) {
+	return newPidAutotuner(this, setpoint, 0.0, amplitude, 0.0, 4, ZIEGLER_NICHOLS);
+}
+
+PidTuningRule getRule(PidAutotuner *this) {
+	return this ? this->rule : ZIEGLER_NICHOLS;
+}
+
+void setRule(PidAutotuner *this, PidTuningRule rule) {
+	if (this) {
+		this->rule = rule;
+	}
+}
+
+bool isFinished(PidAutotuner *this) {
+	return this ? this->finished : true;
+}
+
+float getOutput(PidAutotuner *this) {
+	return this ? this->output : 0.0;
+}
+
+float getUltimateGain(PidAutotuner *this) {
+	return this ? this->Ku : 0.0;
+}
+
+float getUltimatePeriod(PidAutotuner *this) {
+	return this ? this->Tu : 0.0;
+}
+
+/**
+ * Finish a measured oscillation, and the experiment once enough are in.
+ */
+void endCycle(PidAutotuner *this, long time) {
+	if (this->measured >= 0) {
+		this->periodSum += time - this->cycleStart;
+		this->heightSum += (this->maxValue - this->minValue) / 2.0;
+	}
+	this->measured++;
+	this->cycleStart = time;
+	this->maxValue = this->minValue = this->setpoint;
+
+	if (this->measured < this->cycles) {
+		return;
+	}
+	float height = this->heightSum / this->cycles;
+	// Describing function of a relay with hysteresis.
+	float a = sqrt(max(height * height - this->hysteresis * this->hysteresis,
+			0.0));
+
+	this->Tu = this->periodSum / this->cycles;
+	this->Ku = (a > 0.0) ? 4.0 * this->amplitude / (PI * a) : 0.0;
+	this->output = this->bias;
+	this->finished = true;
+}
+
+/**
+ * Run the relay for one tick.
+ *
+ * @param 	this           	Pointer to PidAutotuner struct.
+ * @param 	processVariable	Measured process variable.
+ * @param 	time           	Current time (ms).
+ *
+ * @return	Output to apply to the mechanism.
+ */
+float update(PidAutotuner *this, float processVariable, long time) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	if (this->finished) {
+		return this->output;
+	}
+	this->maxValue = max(this->maxValue, processVariable);
+	this->minValue = min(this->minValue, processVariable);
+
+	if (this->high && processVariable > this->setpoint + this->hysteresis) {
+		this->high = false;
+	} else if (!this->high
+			&& processVariable < this->setpoint - this->hysteresis) {
+		this->high = true;
+		endCycle(this, time);
+	}
+	if (!this->finished) {
+		this->output = this->bias
+				+ (this->high ? this->amplitude : -this->amplitude);
+	}
+	return this->output;
+}
+
+float update(PidAutotuner *this, float processVariable) {
+	return update(this, processVariable, nSysTime);
+}
+
+/**
+ * Set gains from the measured ultimate gain and period, using the tuning
+ * rule. Gains are per ms, like Pid.
+ *
+ * @param 	this	Pointer to PidAutotuner struct.
+ * @param 	pid 	Pointer to Pid struct to tune.
+ *
+ * @return	true if the experiment has finished and the gains were set.
+ */
+bool applyGains(PidAutotuner *this, Pid *pid) {
+	if (this == NULL || pid == NULL || !this->finished || this->Ku <= 0.0) {
+		return false;
+	}
+	float Kp, Ti, Td;
+
+	switch (this->rule) {
+		case TYREUS_LUYBEN:
+			Kp = this->Ku / 2.2;
+			Ti = 2.2 * this->Tu;
+			Td = this->Tu / 6.3;
+			break;
+		case PESSEN_INTEGRAL:
+			Kp = 0.7 * this->Ku;
+			Ti = 0.4 * this->Tu;
+			Td = 0.15 * this->Tu;
+			break;
+		case SOME_OVERSHOOT:
+			Kp = this->Ku / 3.0;
+			Ti = this->Tu / 2.0;
+			Td = this->Tu / 3.0;
+			break;
+		case NO_OVERSHOOT:
+			Kp = 0.2 * this->Ku;
+			Ti = this->Tu / 2.0;
+			Td = this->Tu / 3.0;
+			break;
+		default:
+			Kp = 0.6 * this->Ku;
+			Ti = this->Tu / 2.0;
+			Td = this->Tu / 8.0;
+			break;
+	}
+	setKp(pid, Kp);
+	setKi(pid, Kp / Ti);
+	setKd(pid, Kp * Td);
+
+	return true;
+}
+
+void print(PidAutotuner *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Finished: %d\n", this->finished);
+	writeDebugStream("Ku=%f; Tu=%f ms\n", this->Ku, this->Tu);
+}
+
+#endif  // PIDAUTOTUNER_C_
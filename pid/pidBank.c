@@ -0,0 +1,285 @@
+#pragma systemFile
+
+#if !defined(PIDBANK_C_)
+#define PIDBANK_C_
+
+#define PIDBANK_CAPACITY	12
+#define PIDBANK_NO_LIMIT	1.0e30
+
+#include "../util/math.c"
+
+// Several PID controllers updated together against one timestamp, without a
+// semaphore.
+//
+// setSetpoint() may be called from any task. It writes a per-controller
+// staging slot, then bumps that slot's sequence number. publishSetpoints()
+// copies every slot whose sequence moved into the inactive half of a double
+// buffer, then flips the buffer index, which is a single short write, so all
+// of them take effect in the same update(). A value staged while publishing
+// is picked up by the next publish, never overwritten. Call
+// publishSetpoints() from one task only.
+//
+// Each controller uses the same law as Pid: integral in output units,
+// filtered derivative on measurement, output limits with back-calculation
+// anti-windup, and an optional integral zone. Gain scheduling, feedforward
+// and settling are left to Pid.
+typedef struct {
+	short size;
+
+	float Kp[PIDBANK_CAPACITY];
+	float Ki[PIDBANK_CAPACITY];
+	float Kd[PIDBANK_CAPACITY];
+	float Kb[PIDBANK_CAPACITY];  // Back-calculation gain (/ms), or 0 for Ki / Kp.
+
+	float minOutputs[PIDBANK_CAPACITY];
+	float maxOutputs[PIDBANK_CAPACITY];
+	float integralZones[PIDBANK_CAPACITY];      // Or 0.
+	float derivativeFilters[PIDBANK_CAPACITY];  // ms, or 0.
+
+	float staged[PIDBANK_CAPACITY];
+	long stagedSequences[PIDBANK_CAPACITY];
+	long publishedSequences[PIDBANK_CAPACITY];
+
+	float setpointBuffers[2][PIDBANK_CAPACITY];
+	short setpointIndex;  // Active buffer.
+	short readingIndex;   // Buffer update() is reading, or -1.
+
+	long time;
+	float setpoints[PIDBANK_CAPACITY];  // Used by the last update().
+	float integrals[PIDBANK_CAPACITY];  // Output units.
+	float errors[PIDBANK_CAPACITY];
+	float lastProcessVariables[PIDBANK_CAPACITY];
+	float derivatives[PIDBANK_CAPACITY];
+
+	float controlVariables[PIDBANK_CAPACITY];
+} PidBank;
+
+PidBank *newPidBank(PidBank *this) {
+	if (this) {
+		this->size = 0;
+		this->setpointIndex = 0;
+		this->readingIndex = -1;
+		this->time = 0;
+	}
+	return this;
+}
+
+/**
+ * Add a controller to the bank.
+ *
+ * @param 	this    	Pointer to PidBank struct.
+ * @param 	Kp      	Proportional gain.
+ * @param 	Ki      	Integral gain.
+ * @param 	Kd      	Derivative gain.
+ * @param 	setpoint	Initial setpoint.
+ *
+ * @return	Index of the controller, or -1 if the bank is full.
+ */
+short addPid(PidBank *this, float Kp, float Ki, float Kd, float setpoint) {
+	if (this == NULL || this->size >= PIDBANK_CAPACITY) {
+		return -1;
+	}
+	short i = this->size;
+
+	this->Kp[i] = Kp;
+	this->Ki[i] = Ki;
+	this->Kd[i] = Kd;
+	this->Kb[i] = 0.0;
+
+	this->minOutputs[i] = -PIDBANK_NO_LIMIT;
+	this->maxOutputs[i] = PIDBANK_NO_LIMIT;
+	this->integralZones[i] = 0.0;
+	this->derivativeFilters[i] = 0.0;
+
+	this->staged[i] = setpoint;
+	this->stagedSequences[i] = 0;
+	this->publishedSequences[i] = 0;
+
+	this->setpointBuffers[0][i] = setpoint;
+	this->setpointBuffers[1][i] = setpoint;
+
+	this->setpoints[i] = setpoint;
+	this->integrals[i] = 0.0;
+	this->errors[i] = 0.0;
+	this->lastProcessVariables[i] = 0.0;
+	this->derivatives[i] = 0.0;
+
+	this->controlVariables[i] = 0.0;
+
+	return this->size++;
+}
+
+short getSize(PidBank *this) {
+	return this ? this->size : 0;
+}
+
+void setGains(PidBank *this, short index, float Kp, float Ki, float Kd) {
+	if (this && index >= 0 && index < this->size) {
+		this->Kp[index] = Kp;
+		this->Ki[index] = Ki;
+		this->Kd[index] = Kd;
+	}
+}
+
+void setKb(PidBank *this, short index, float Kb) {
+	if (this && index >= 0 && index < this->size) {
+		this->Kb[index] = Kb;
+	}
+}
+
+void setOutputLimits(PidBank *this, short index, float minOutput,
+		float maxOutput) {
+	if (this && index >= 0 && index < this->size) {
+		this->minOutputs[index] = minOutput;
+		this->maxOutputs[index] = maxOutput;
+	}
+}
+
+void setIntegralZone(PidBank *this, short index, float integralZone) {
+	if (this && index >= 0 && index < this->size) {
+		this->integralZones[index] = integralZone;
+	}
+}
+
+void setDerivativeFilter(PidBank *this, short index, float derivativeFilter) {
+	if (this && index >= 0 && index < this->size) {
+		this->derivativeFilters[index] = derivativeFilter;
+	}
+}
+
+/**
+ * Get the active setpoint of a controller.
+ */
+float getSetpoint(PidBank *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->setpointBuffers[this->setpointIndex][index] : 0.0;
+}
+
+/**
+ * Stage a setpoint. It takes effect at the next publishSetpoints().
+ */
+void setSetpoint(PidBank *this, short index, float setpoint) {
+	if (this && index >= 0 && index < this->size) {
+		// Value first, so a publish that sees the new sequence sees the value.
+		this->staged[index] = setpoint;
+		this->stagedSequences[index]++;
+	}
+}
+
+/**
+ * Make all staged setpoints active at once.
+ *
+ * @param 	this	Pointer to PidBank struct.
+ *
+ * @return	false if update() is still reading the inactive buffer; nothing
+ *        	was published, so call again next tick.
+ */
+bool publishSetpoints(PidBank *this) {
+	if (this == NULL) {
+		return false;
+	}
+	short active = this->setpointIndex;
+	short inactive = 1 - active;
+
+	if (this->readingIndex == inactive) {
+		return false;
+	}
+	for (short i = 0; i < this->size; i++) {
+		long sequence = this->stagedSequences[i];
+
+		if (sequence != this->publishedSequences[i]) {
+			this->setpointBuffers[inactive][i] = this->staged[i];
+			this->publishedSequences[i] = sequence;
+		} else {
+			this->setpointBuffers[inactive][i] = this->setpointBuffers[active][i];
+		}
+	}
+	this->setpointIndex = inactive;
+
+	return true;
+}
+
+float getControlVariable(PidBank *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->controlVariables[index] : 0.0;
+}
+
+/**
+ * Update every controller with one read of the clock. A controller whose
+ * setpoint changed restarts its integration step and derivative, as
+ * setSetpoint() does for a Pid, but keeps its integral.
+ *
+ * @param 	this            	Pointer to PidBank struct.
+ * @param 	processVariables	Array of process variables, one per controller.
+ */
+void update(PidBank *this, const float *processVariables) {
+	if (this == NULL || processVariables == NULL) {
+		return;
+	}
+	long now = nSysTime;
+	long elapsed = (this->time == 0) ? 0 : now - this->time;
+	// Mark the buffer in use before reading it, and check that no publish
+	// flipped the index in between, so one pass uses one unchanging buffer.
+	short index;
+	do {
+		index = this->setpointIndex;
+		this->readingIndex = index;
+	} while (index != this->setpointIndex);
+
+	for (short i = 0; i < this->size; i++) {
+		float setpoint = this->setpointBuffers[index][i];
+		float processVariable = processVariables[i];
+		float error = setpoint - processVariable;
+		long dt = elapsed;
+
+		if (setpoint != this->setpoints[i] || this->time == 0) {
+			this->setpoints[i] = setpoint;
+			this->lastProcessVariables[i] = processVariable;
+			this->derivatives[i] = 0.0;
+			dt = 0;
+		}
+		if (this->integralZones[i] > 0.0
+				&& fabs(error) > this->integralZones[i]) {
+			this->integrals[i] = 0.0;
+		} else {
+			this->integrals[i] += this->Ki[i] * error * dt;
+		}
+		if (dt > 0) {
+			// Derivative on measurement, so setpoint changes do not kick.
+			float derivative = (this->lastProcessVariables[i] - processVariable)
+					/ dt;
+
+			this->derivatives[i] += dt / (this->derivativeFilters[i] + dt)
+					* (derivative - this->derivatives[i]);
+		}
+		float output = this->Kp[i] * error + this->integrals[i]
+				+ this->Kd[i] * this->derivatives[i];
+		float controlVariable = max(min(output, this->maxOutputs[i]),
+				this->minOutputs[i]);
+
+		// Back-calculation, as in Pid.
+		if (controlVariable != output) {
+			float Kb = (this->Kb[i] > 0.0) ? this->Kb[i]
+					: ((this->Kp[i] != 0.0) ? this->Ki[i] / this->Kp[i] : 0.0);
+
+			this->integrals[i] += min(Kb * dt, 1.0) * (controlVariable - output);
+		}
+		this->controlVariables[i] = controlVariable;
+		this->errors[i] = error;
+		this->lastProcessVariables[i] = processVariable;
+	}
+	this->readingIndex = -1;
+	this->time = now;
+}
+
+void print(PidBank *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		writeDebugStream("%d: setpoint=%f; error=%f; controlVariable=%f\n", i,
+				this->setpoints[i], this->errors[i], this->controlVariables[i]);
+	}
+}
+
+#endif  // PIDBANK_C_
@@ -0,0 +1,387 @@
+#pragma systemFile
+
+#if !defined(VELOCITYCONTROLLER_C_)
+#define VELOCITYCONTROLLER_C_
+
+#include "../util/math.c"
+#include "../components/encoderWheel.c"
+#include "../components/sensorFrame.c"
+#include "../components/motor.c"
+#include "./pid.c"
+
+typedef struct {
+	float kS;  // Output to overcome static friction.
+	float kV;  // Output per unit/s.
+	float kA;  // Output per unit/s^2.
+
+	Pid pid;
+	EncoderWheel *encoder;
+
+	float targetVelocity;
+	float targetAcceleration;
+
+	float velocity;  // units/s.
+	float lastDistance;
+	unsigned long time;
+
+	float output;
+} VelocityController;
+
+/**
+ * Initialize velocity controller.
+ *
+ * @param 	this   	Pointer to VelocityController struct.
+ * @param 	encoder	Encoder wheel measuring the mechanism.
+ * @param 	kS     	Static friction feedforward.
+ * @param 	kV     	Velocity feedforward.
+ * @param 	kA     	Acceleration feedforward.
+ * @param 	Kp     	Proportional gain on velocity error.
+ * @param 	Ki     	Integral gain on velocity error.
+ * @param 	Kd     	Derivative gain on velocity error.
+ *
+ * @return	Pointer to VelocityController struct.
+ */
+VelocityController *newVelocityController(VelocityController *this,
+		EncoderWheel *encoder, float kS, float kV, float kA, float Kp, float Ki,
+		float Kd) {
+	if (this) {
+		this->kS = kS;
+		this->kV = kV;
+		this->kA = kA;
+
+		// Feedforward runs through the Pid, so its output limits cover the sum
+		// and anti-windup stops the integral once the motor saturates.
+		newPid(&this->pid, Kp, Ki, Kd, 0.0);
+		setOutputLimits(&this->pid, -MOTOR_MAX_OUTPUT, MOTOR_MAX_OUTPUT);
+		this->encoder = encoder;
+
+		this->targetVelocity = 0.0;
+		this->targetAcceleration = 0.0;
+
+		this->velocity = 0.0;
+		this->lastDistance = getDistance(encoder);
+		this->time = 0;
+
+		this->output = 0.0;
+	}
+	return this;
+}
+
+VelocityController *newVelocityController(VelocityController *this,
+		EncoderWheel *encoder, float kS, float kV, float kA) {
+	return newVelocityController(this, encoder, kS, kV, kA, 0.0, 0.0, 0.0);
+}
+
+float getKs(VelocityController *this) {
+	return this ? this->kS : 0.0;
+}
+
+void setKs(VelocityController *this, float kS) {
+	if (this) {
+		this->kS = kS;
+	}
+}
+
+float getKv(VelocityController *this) {
+	return this ? this->kV : 0.0;
+}
+
+void setKv(VelocityController *this, float kV) {
+	if (this) {
+		this->kV = kV;
+	}
+}
+
+float getKa(VelocityController *this) {
+	return this ? this->kA : 0.0;
+}
+
+void setKa(VelocityController *this, float kA) {
+	if (this) {
+		this->kA = kA;
+	}
+}
+
+Pid *getPid(VelocityController *this) {
+	return this ? &this->pid : NULL;
+}
+
+float getVelocity(VelocityController *this) {
+	return this ? this->velocity : 0.0;
+}
+
+float getOutput(VelocityController *this) {
+	return this ? this->output : 0.0;
+}
+
+/**
+ * Set the velocity to track. A changed velocity goes through setSetpoint()
+ * on the Pid, which restarts its integration step, derivative and settle
+ * timer; an unchanged one leaves the Pid alone, so this can be called every
+ * tick.
+ *
+ * @param 	this        	Pointer to VelocityController struct.
+ * @param 	velocity    	Target velocity (units/s).
+ * @param 	acceleration	Target acceleration (units/s^2).
+ */
+void setTarget(VelocityController *this, float velocity, float acceleration) {
+	if (this) {
+		this->targetVelocity = velocity;
+		this->targetAcceleration = acceleration;
+		if (velocity != getSetpoint(&this->pid)) {
+			setSetpoint(&this->pid, velocity);
+		}
+	}
+}
+
+void setTarget(VelocityController *this, float velocity) {
+	setTarget(this, velocity, 0.0);
+}
+
+/**
+ * Get the feedforward output for a velocity and acceleration.
+ */
+float getFeedforward(VelocityController *this, float velocity,
+		float acceleration) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	return this->kS * sgn(velocity) + this->kV * velocity
+			+ this->kA * acceleration;
+}
+
+/**
+ * Measure velocity from a distance and compute the output.
+ *
+ * @param 	this    	Pointer to VelocityController struct.
+ * @param 	distance	Encoder distance.
+ * @param 	time    	Time of the distance (ms).
+ *
+ * @return	Output at nominal battery voltage, for motorSetCompensated() or a
+ *        	MotorBuffer.
+ */
+float update(VelocityController *this, float distance, unsigned long time) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	if (this->time == 0) {
+		this->time = time;
+		this->lastDistance = distance;
+	}
+	unsigned long dt = time - this->time;
+
+	if (dt > 0) {
+		this->velocity = (distance - this->lastDistance) * 1000.0 / dt;
+		this->lastDistance = distance;
+		this->time += dt;
+	}
+	setFeedforward(&this->pid, getFeedforward(this, this->targetVelocity,
+			this->targetAcceleration));
+	update(&this->pid, this->velocity);
+
+	this->output = this->pid.controlVariable;
+
+	return this->output;
+}
+
+/**
+ * Measure velocity and compute the output. Call once per tick.
+ *
+ * @param 	this	Pointer to VelocityController struct.
+ *
+ * @return	Output at nominal battery voltage.
+ */
+float update(VelocityController *this) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	return update(this, getDistance(this->encoder), nSysTime);
+}
+
+/**
+ * Measure velocity from the pulse count in a sensor frame and compute the
+ * output. Call once per tick, after update() on the frame.
+ *
+ * @param 	this 	Pointer to VelocityController struct.
+ * @param 	frame	Pointer to SensorFrame struct.
+ *
+ * @return	Output at nominal battery voltage.
+ */
+float update(VelocityController *this, SensorFrame *frame) {
+	if (this == NULL || frame == NULL) {
+		return 0.0;
+	}
+	return update(this, getDistance(this->encoder, frame), getTime(frame));
+}
+
+void print(VelocityController *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("kS=%f; kV=%f; kA=%f\n", this->kS, this->kV, this->kA);
+	writeDebugStream("Target: %f\n", this->targetVelocity);
+	writeDebugStream("Velocity: %f\n", this->velocity);
+	writeDebugStream("Output: %f\n", this->output);
+}
+
+// Least squares fit of output = kS*sgn(v) + kV*v + kA*a. Only the normal
+// equation sums are kept, so a test can log any number of samples.
+typedef struct {
+	float sums[3][3];
+	float rhs[3];
+	long samples;
+
+	float kS;
+	float kV;
+	float kA;
+} VelocityCharacterization;
+
+VelocityCharacterization *newVelocityCharacterization(
+		VelocityCharacterization *this) {
+	if (this) {
+		for (short i = 0; i < 3; i++) {
+			for (short j = 0; j < 3; j++) {
+				this->sums[i][j] = 0.0;
+			}
+			this->rhs[i] = 0.0;
+		}
+		this->samples = 0;
+
+		this->kS = 0.0;
+		this->kV = 0.0;
+		this->kA = 0.0;
+	}
+	return this;
+}
+
+void addSample(VelocityCharacterization *this, float output, float velocity,
+		float acceleration) {
+	if (this == NULL || velocity == 0.0) {
+		return;  // Static friction direction is unknown at rest.
+	}
+	float row[3];
+	row[0] = sgn(velocity);
+	row[1] = velocity;
+	row[2] = acceleration;
+
+	for (short i = 0; i < 3; i++) {
+		for (short j = 0; j < 3; j++) {
+			this->sums[i][j] += row[i] * row[j];
+		}
+		this->rhs[i] += row[i] * output;
+	}
+	this->samples++;
+}
+
+float determinant(float m00, float m01, float m02, float m10, float m11,
+		float m12, float m20, float m21, float m22) {
+	return m00 * (m11 * m22 - m12 * m21) - m01 * (m10 * m22 - m12 * m20)
+			+ m02 * (m10 * m21 - m11 * m20);
+}
+
+/**
+ * Solve for kS, kV and kA.
+ *
+ * @param 	this	Pointer to VelocityCharacterization struct.
+ *
+ * @return	true if the samples determine all three gains, false otherwise.
+ */
+bool solve(VelocityCharacterization *this) {
+	if (this == NULL || this->samples < 3) {
+		return false;
+	}
+	float m[3][3];
+	for (short i = 0; i < 3; i++) {
+		for (short j = 0; j < 3; j++) {
+			m[i][j] = this->sums[i][j];
+		}
+	}
+	float r[3];
+	for (short i = 0; i < 3; i++) {
+		r[i] = this->rhs[i];
+	}
+	float det = determinant(m[0][0], m[0][1], m[0][2], m[1][0], m[1][1], m[1][2],
+			m[2][0], m[2][1], m[2][2]);
+
+	if (fabs(det) < 0.000001) {
+		return false;
+	}
+	// Cramer's rule.
+	this->kS = determinant(r[0], m[0][1], m[0][2], r[1], m[1][1], m[1][2],
+			r[2], m[2][1], m[2][2]) / det;
+	this->kV = determinant(m[0][0], r[0], m[0][2], m[1][0], r[1], m[1][2],
+			m[2][0], r[2], m[2][2]) / det;
+	this->kA = determinant(m[0][0], m[0][1], r[0], m[1][0], m[1][1], r[1],
+			m[2][0], m[2][1], r[2]) / det;
+
+	return true;
+}
+
+/**
+ * Run a characterization test: a slow output ramp (mostly kS and kV)
+ * followed by a step (mostly kA). Sleeps for the duration of the test and
+ * leaves the motor stopped.
+ *
+ * @param 	this    	Pointer to VelocityCharacterization struct.
+ * @param 	port    	Motor port driving the mechanism.
+ * @param 	encoder 	Encoder wheel measuring the mechanism.
+ * @param 	rampRate	Ramp rate (output/s).
+ * @param 	step    	Step output.
+ * @param 	duration	Duration of each phase (ms).
+ *
+ * @return	true if the fit succeeded, false otherwise.
+ */
+bool characterize(VelocityCharacterization *this, tMotor port,
+		EncoderWheel *encoder, float rampRate, float step, long duration) {
+	if (this == NULL || encoder == NULL) {
+		return false;
+	}
+	newVelocityCharacterization(this);
+
+	for (short phase = 0; phase < 2; phase++) {
+		motorSetCompensated(port, 0.0);
+		sleep(1000);  // Let the mechanism come to rest.
+
+		float lastDistance = getDistance(encoder);
+		float lastVelocity = 0.0;
+		unsigned long start = nSysTime;
+		unsigned long time = start;
+
+		while (nSysTime - start < duration) {
+			float output = (phase == 0) ? rampRate * (nSysTime - start) / 1000.0
+					: step;
+
+			// Log what the motor received, which differs from output once the
+			// ramp saturates.
+			short applied = motorCompensate(output);
+			motor[port] = applied;
+			output = applied / motorBatteryScale;
+			sleep(20);
+
+			unsigned long dt = nSysTime - time;
+			float distance = getDistance(encoder);
+			float velocity = (distance - lastDistance) * 1000.0 / dt;
+			float acceleration = (velocity - lastVelocity) * 1000.0 / dt;
+
+			// Applied output at nominal voltage, matching what update() produces.
+			addSample(this, output, velocity, acceleration);
+
+			lastDistance = distance;
+			lastVelocity = velocity;
+			time += dt;
+		}
+	}
+	motorSetCompensated(port, 0.0);
+
+	return solve(this);
+}
+
+void print(VelocityCharacterization *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Samples: %d\n", this->samples);
+	writeDebugStream("kS=%f; kV=%f; kA=%f\n", this->kS, this->kV, this->kA);
+}
+
+#endif  // VELOCITYCONTROLLER_C_
@@ -0,0 +1,34 @@
+#include "../navigator/driveKinematics.c"
+
+#define MAX_WHEEL_VEL	60.0  // in/s.
+#define MAX_TURN_RATE	4.0   // radians/s.
+
+task main() {
+	// Mecanum drive, 14" track width, 12" wheel base.
+	DriveKinematics kinematics;
+	newDriveKinematics(&kinematics, MECANUM_DRIVE, 14.0, 12.0, MAX_WHEEL_VEL);
+
+	float commands[DRIVEKINEMATICS_MAX_WHEELS];
+	float forward, strafe, turn;
+
+	while (true) {
+		// Arcade control: left stick drives and strafes, right stick turns.
+		toWheels(&kinematics, vexRT[Ch3] / 127.0 * MAX_WHEEL_VEL,
+				vexRT[Ch4] / 127.0 * MAX_WHEEL_VEL, -vexRT[Ch1] / 127.0 * MAX_TURN_RATE,
+				commands);
+
+		motor[port2] = commands[0] * 127;  // Front left.
+		motor[port3] = commands[1] * 127;  // Front right.
+		motor[port4] = commands[2] * 127;  // Back left.
+		motor[port5] = commands[3] * 127;  // Back right.
+
+		// Chassis velocity the commands produce, at full battery.
+		for (short i = 0; i < getWheels(&kinematics); i++) {
+			commands[i] *= MAX_WHEEL_VEL;
+		}
+		toChassis(&kinematics, commands, &forward, &strafe, &turn);
+		writeDebugStream("forward=%f; strafe=%f; turn=%f\n", forward, strafe, turn);
+
+		sleep(15);
+	}
+}
@@ -0,0 +1,58 @@
+#include "../components/encoderVelocity.c"
+
+#define DURATION	10000  // ms.
+#define PERIOD  	4000.0 // ms.
+#define PEAK    	6.0    // in/s, slow enough to be a few pulses per tick.
+
+/**
+ * Compare the estimator to differencing each tick, against a simulated
+ * encoder moving at PEAK * sin(2 Pi t / PERIOD). The longest window should
+ * reach maxWindow at any tick.
+ */
+void testSine(EncoderWheel *encoder, long tick) {
+	EncoderVelocity estimator;
+	newEncoderVelocity(&estimator, encoder);
+
+	float distancePerPulse = getDistancePerPulse(encoder);
+	float sumError = 0.0;
+	float sumNaiveError = 0.0;
+	float sumWindow = 0.0;
+	long maxWindow = 0;
+	long lastPulses = 0;
+	short ticks = 0;
+
+	for (long t = 0; t <= DURATION; t += tick) {
+		float w = 2.0 * PI / PERIOD;
+		float position = PEAK / w * (1.0 - cos(w * t)) / 1000.0;  // in.
+		long pulses = floor(position / distancePerPulse);
+		float velocity = PEAK * sin(w * t);
+
+		update(&estimator, pulses, t);
+		float naive = (pulses - lastPulses) * distancePerPulse * 1000.0 / tick;
+		lastPulses = pulses;
+
+		if (t > 0) {
+			sumError += pow(getVelocity(&estimator) - velocity, 2.0);
+			sumNaiveError += pow(naive - velocity, 2.0);
+			sumWindow += getWindow(&estimator);
+			if (getWindow(&estimator) > maxWindow) {
+				maxWindow = getWindow(&estimator);
+			}
+			ticks++;
+		}
+	}
+	writeDebugStream("Tick: %d ms\n", tick);
+	writeDebugStream("RMS error, differencing: %f in/s\n", sqrt(sumNaiveError / ticks));
+	writeDebugStream("RMS error, adaptive window: %f in/s\n", sqrt(sumError / ticks));
+	writeDebugStream("Mean window: %f ms (latency about half)\n", sumWindow / ticks);
+	writeDebugStream("Max window: %d ms\n", maxWindow);
+}
+
+task main() {
+	EncoderWheel encoder;
+	newEncoderWheel(&encoder, dgtl1, 360.0, 3.25);
+	clearDebugStream();
+
+	testSine(&encoder, 15);
+	testSine(&encoder, 2);  // Faster than the buffer holds at one count per tick.
+}
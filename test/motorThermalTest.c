@@ -0,0 +1,133 @@
+#include "../components/motorThermal.c"
+
+// Simulated 393 (torque gearing) driving a lift that stalls against a hard
+// stop. The plant has its own constants, from a measured motor and from the
+// PTC's trip curve rather than from the model, so the test shows how far
+// the model is off. The model only sees the commanded output, a quantized
+// speed measurement and the battery level.
+#define SIM_BATTERY_LEVEL	7800.0  // mV.
+#define SIM_DT           	10      // ms.
+#define SIM_DURATION     	30000   // ms.
+
+// Measured 393 at 7.2 V: stall and free current, free speed.
+#define PLANT_TEST_VOLTAGE 	7.2
+#define PLANT_STALL_CURRENT	5.2   // A.
+#define PLANT_FREE_CURRENT 	0.4   // A.
+#define PLANT_FREE_SPEED   	95.0  // rpm.
+
+// PTC trip curve: never trips at the hold current, trips in TRIP_TIME at
+// TRIP_CURRENT from ambient.
+#define PLANT_HOLD_CURRENT 	1.1     // A.
+#define PLANT_TRIP_CURRENT 	5.0     // A.
+#define PLANT_TRIP_TIME    	2200.0  // ms.
+
+float plantResistance;
+float plantBackEmf;   // V/rpm.
+float plantHeating;   // C/ms/A^2.
+float plantCooling;   // 1/ms.
+
+void initPlant() {
+	plantResistance = PLANT_TEST_VOLTAGE / PLANT_STALL_CURRENT;
+	plantBackEmf = (PLANT_TEST_VOLTAGE - PLANT_FREE_CURRENT * plantResistance)
+			/ PLANT_FREE_SPEED;
+	// First order PTC: at the hold current the steady state is the trip
+	// temperature, and from T = Ta + (Ttrip - Ta) * I^2 / Ihold^2
+	// * (1 - e^(-cooling * t)) the trip point gives the cooling rate.
+	float holdRatio = pow(PLANT_HOLD_CURRENT / PLANT_TRIP_CURRENT, 2.0);
+	plantCooling = -log(1.0 - holdRatio) / PLANT_TRIP_TIME;
+	plantHeating = plantCooling
+			* (MOTORTHERMAL_TRIP_TEMPERATURE - MOTORTHERMAL_AMBIENT)
+			/ (PLANT_HOLD_CURRENT * PLANT_HOLD_CURRENT);
+}
+
+typedef struct {
+	float rpm;
+	float position;
+	float temperature;
+	bool tripped;
+} SimMotor;
+
+void newSimMotor(SimMotor *sim) {
+	sim->rpm = 0.0;
+	sim->position = 0.0;
+	sim->temperature = MOTORTHERMAL_AMBIENT;
+	sim->tripped = false;
+}
+
+// Step the simulated motor and return the true current.
+float step(SimMotor *sim, float output) {
+	if (sim->tripped) {
+		output = 0.0;
+	}
+	float voltage = output / MOTOR_MAX_OUTPUT * SIM_BATTERY_LEVEL / 1000.0;
+	float current = (voltage - plantBackEmf * sim->rpm) / plantResistance;
+	// Torque (in rpm/ms) minus gravity load and viscous friction.
+	float acc = 0.4 * current - 0.15 - 0.002 * sim->rpm;
+
+	sim->rpm += acc * SIM_DT;
+	sim->position += sim->rpm * SIM_DT / 60000.0;
+	if (sim->position >= 2.0 && sim->rpm > 0.0) {
+		sim->position = 2.0;  // Hard stop after two revolutions.
+		sim->rpm = 0.0;
+	} else if (sim->position <= 0.0 && sim->rpm < 0.0) {
+		sim->position = 0.0;
+		sim->rpm = 0.0;
+	}
+	sim->temperature += (current * current * plantHeating
+			- (sim->temperature - MOTORTHERMAL_AMBIENT) * plantCooling) * SIM_DT;
+	if (sim->temperature >= MOTORTHERMAL_TRIP_TEMPERATURE) {
+		sim->tripped = true;
+	}
+	return current;
+}
+
+void run(bool limited, float limitTemperature) {
+	SimMotor sim;
+	newSimMotor(&sim);
+
+	MotorThermal model;
+	newMotorThermal(&model, port2, 100.0, limitTemperature);
+
+	float maxError = 0.0;
+	long tripTime = -1;
+
+	for (long t = 0; t < SIM_DURATION; t += SIM_DT) {
+		float output = 127.0;
+		float measuredRpm = (short)(sim.rpm / 2.0) * 2.0;  // Encoder quantization.
+
+		if (limited) {
+			output = limitOutput(&model, output, measuredRpm, SIM_BATTERY_LEVEL);
+		}
+		step(&sim, output);
+		update(&model, output, measuredRpm, SIM_BATTERY_LEVEL, SIM_DT);
+
+		// Once tripped the plant gets no current, so stop comparing.
+		if (!sim.tripped) {
+			maxError = max(maxError, fabs(model.temperature - sim.temperature));
+		}
+		if (sim.tripped && tripTime < 0) {
+			tripTime = t;
+		}
+	}
+	writeDebugStream("Limited: %s (limit %f)\n", toString(limited),
+			limitTemperature);
+	writeDebugStream("  Trip time: %d ms\n", tripTime);
+	writeDebugStream("  Final temperature: %f (model %f)\n", sim.temperature,
+			model.temperature);
+	writeDebugStream("  Max model vs plant temperature error: %f\n", maxError);
+	if (limited) {
+		writeDebugStream("  Limiter prevented trip: %s\n", toString(tripTime < 0));
+	}
+}
+
+task main() {
+	clearDebugStream();
+	initPlant();
+
+	// The model is calibrated from the fast end of the trip curve, so it runs
+	// a few degrees hot and the default limit holds the plant under the trip
+	// temperature.
+	run(false, 0.9 * MOTORTHERMAL_TRIP_TEMPERATURE);  // Trips within a few seconds.
+	run(true, 0.9 * MOTORTHERMAL_TRIP_TEMPERATURE);   // Default limit.
+	run(true, 0.8 * MOTORTHERMAL_TRIP_TEMPERATURE);
+}
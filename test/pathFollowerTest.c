@@ -0,0 +1,101 @@
+#include "../navigator/pathFollower.c"
+
+// Simulated tank drive, so the followers can be compared without a robot.
+// The simulation only moves the wheels and sets the encoder counts; the pose
+// comes from Navigator, as it does on the robot.
+#define SIM_DT         	0.01  // s.
+#define SIM_TIMEOUT    	10.0  // s.
+#define SIM_WHEEL_LAG  	0.1   // s, wheel velocity time constant.
+#define DRIVE_WIDTH    	14.0  // in.
+
+typedef struct {
+	float left;   // Wheel velocities.
+	float right;
+	float leftDistance;
+	float rightDistance;
+} SimDrive;
+
+void step(SimDrive *sim, EncoderWheel *leftEncoder, EncoderWheel *rightEncoder,
+		float leftTarget, float rightTarget) {
+	sim->left += (leftTarget - sim->left) * SIM_DT / SIM_WHEEL_LAG;
+	sim->right += (rightTarget - sim->right) * SIM_DT / SIM_WHEEL_LAG;
+
+	sim->leftDistance += sim->left * SIM_DT;
+	sim->rightDistance += sim->right * SIM_DT;
+
+	SensorValue[getPort(leftEncoder)] = round(sim->leftDistance
+			/ getDistancePerPulse(leftEncoder));
+	SensorValue[getPort(rightEncoder)] = round(sim->rightDistance
+			/ getDistancePerPulse(rightEncoder));
+}
+
+void run(PathFollowerMode mode, Path *path, PathProfile *profile) {
+	SimDrive sim;
+	sim.left = 0.0;
+	sim.right = 0.0;
+	sim.leftDistance = 0.0;
+	sim.rightDistance = 0.0;
+
+	EncoderWheel leftEncoder;
+	newEncoderWheel(&leftEncoder, dgtl1, 360.0, 3.25);
+	EncoderWheel rightEncoder;
+	newEncoderWheel(&rightEncoder, dgtl3, 360.0, 3.25);
+	SensorType[dgtl1] = sensorQuadEncoder;
+	SensorType[dgtl3] = sensorQuadEncoder;
+	SensorValue[dgtl1] = 0;
+	SensorValue[dgtl3] = 0;
+
+	// Start 2" left of the path and turned 0.1 radians off it. Navigator
+	// heading is clockwise from the y axis.
+	Navigator navigator;
+	newNavigator(&navigator, &leftEncoder, &rightEncoder, DRIVE_WIDTH, 0.0, 2.0,
+			PI / 2.0 - 0.1);
+
+	PathFollower follower;
+	newPathFollower(&follower, mode, path, profile, &navigator, DRIVE_WIDTH);
+	start(&follower);
+
+	float maxError = 0.0;
+	float sumError = 0.0;
+	long steps = 0;
+	float t = 0.0;
+
+	for (; t < SIM_TIMEOUT && !isFinished(&follower); t += SIM_DT) {
+		update(&follower, t);
+		step(&sim, &leftEncoder, &rightEncoder, getLeftVelocity(&follower),
+				getRightVelocity(&follower));
+		update(&navigator);
+
+		float error = fabs(getProjection(&follower)->crossTrack);
+		maxError = max(maxError, error);
+		sumError += error;
+		steps++;
+	}
+	writeDebugStream("%s\n", (mode == RAMSETE) ? "RAMSETE" : "Pure pursuit");
+	writeDebugStream("  Completion time: %f s (profile %f s)\n", t,
+			getDuration(profile));
+	writeDebugStream("  Timed out: %s\n", toString(isTimedOut(&follower)));
+	writeDebugStream("  Max cross track error: %f\n", maxError);
+	writeDebugStream("  Mean cross track error: %f\n", sumError / steps);
+	writeDebugStream("  Final pose: x=%f; y=%f; heading=%f\n", getX(&navigator),
+			getY(&navigator), getHeading(&navigator));
+}
+
+task main() {
+	WaypointSequence sequence;
+	newWaypointSequence(&sequence);
+	addWaypoint(&sequence, 0.0, 0.0, 0.0);
+	addWaypoint(&sequence, 24.0, 12.0, PI / 4.0);
+	addWaypoint(&sequence, 48.0, 48.0, PI / 2.0);
+
+	Path path;
+	newPath(&path, &sequence);
+
+	PathProfile profile;
+	newPathProfile(&profile, 40.0, 80.0, 48.0, DRIVE_WIDTH);
+	plan(&profile, &path, 0.0, 0.0, PATHPROFILE_MAX_POINTS);
+
+	clearDebugStream();
+	run(PURE_PURSUIT, &path, &profile);
+	run(RAMSETE, &path, &profile);
+}
@@ -0,0 +1,66 @@
+#include "../pid/pidAutotuner.c"
+
+// First order plus dead time plant: y' = (gain * u(t - delay) - y) / timeConstant.
+#define PLANT_GAIN         	2.0
+#define PLANT_TIME_CONSTANT	500.0  // ms.
+#define PLANT_DELAY        	100    // ms.
+#define MAX_TIME           	60000  // ms.
+
+float delayed[PLANT_DELAY];
+
+/**
+ * Ultimate gain and period of the plant, from arg G(jw) = -Pi.
+ */
+void printTheoretical() {
+	float low = 0.0001;
+	float high = 0.1;
+
+	for (short i = 0; i < 50; i++) {
+		float w = (low + high) / 2.0;
+
+		if (atan(w * PLANT_TIME_CONSTANT) + w * PLANT_DELAY < PI) {
+			low = w;
+		} else {
+			high = w;
+		}
+	}
+	float w = (low + high) / 2.0;
+	writeDebugStream("Theoretical: Ku=%f; Tu=%f ms\n",
+			sqrt(1.0 + pow(w * PLANT_TIME_CONSTANT, 2.0)) / PLANT_GAIN, 2.0 * PI / w);
+}
+
+void testRule(PidTuningRule rule, char *name) {
+	PidAutotuner autotuner;
+	newPidAutotuner(&autotuner, 20.0, 10.0, 50.0, 0.5, 4, rule);
+
+	for (short i = 0; i < PLANT_DELAY; i++) {
+		delayed[i] = 0.0;
+	}
+	// Simulate at 1 ms steps.
+	float y = 0.0;
+	for (long t = 0; t < MAX_TIME && !isFinished(&autotuner); t++) {
+		short i = t % PLANT_DELAY;
+
+		y += (PLANT_GAIN * delayed[i] - y) / PLANT_TIME_CONSTANT;
+		delayed[i] = update(&autotuner, y, t);
+	}
+
+	Pid pid;
+	newPid(&pid, 0.0, 0.0, 0.0, 0.0);
+	writeDebugStream("%s\n", name);
+	print(&autotuner);
+	if (applyGains(&autotuner, &pid)) {
+		writeDebugStream("Kp=%f; Ki=%f; Kd=%f\n", getKp(&pid), getKi(&pid),
+				getKd(&pid));
+	}
+}
+
+task main() {
+	clearDebugStream();
+
+	printTheoretical();
+	testRule(ZIEGLER_NICHOLS, "Ziegler-Nichols");
+	testRule(TYREUS_LUYBEN, "Tyreus-Luyben");
+	testRule(PESSEN_INTEGRAL, "Pessen integral");
+	testRule(NO_OVERSHOOT, "No overshoot");
+}
@@ -0,0 +1,60 @@
+#include "../pid/pid.c"
+#include "../pid/pidBank.c"
+
+#define CONTROLLERS	12
+#define BENCH_RUNS 	1000
+
+Pid pids[CONTROLLERS];
+PidBank bank;
+float processVariables[CONTROLLERS];
+
+void benchUpdate() {
+	for (short i = 0; i < CONTROLLERS; i++) {
+		newPid(&pids[i], 0.5, 0.001, 2.0, 100.0);
+		setOutputLimits(&pids[i], -127.0, 127.0);
+		addPid(&bank, 0.5, 0.001, 2.0, 100.0);
+		setOutputLimits(&bank, i, -127.0, 127.0);
+		processVariables[i] = i;
+	}
+
+	unsigned long start = nSysTime;
+	for (short run = 0; run < BENCH_RUNS; run++) {
+		for (short i = 0; i < CONTROLLERS; i++) {
+			update(&pids[i], processVariables[i]);
+		}
+	}
+	unsigned long pidTime = nSysTime - start;
+
+	start = nSysTime;
+	for (short run = 0; run < BENCH_RUNS; run++) {
+		update(&bank, processVariables);
+	}
+	unsigned long bankTime = nSysTime - start;
+
+	writeDebugStream("%d controllers x %d runs\n", CONTROLLERS, BENCH_RUNS);
+	writeDebugStream("Separate Pids: %d ms\n", pidTime);
+	writeDebugStream("PidBank: %d ms\n", bankTime);
+}
+
+void testPublish() {
+	// Staged setpoints are not used until published.
+	setSetpoint(&bank, 0, 50.0);
+	setSetpoint(&bank, 1, 60.0);
+	writeDebugStream("Before publish: %f, %f\n", getSetpoint(&bank, 0),
+			getSetpoint(&bank, 1));
+
+	publishSetpoints(&bank);
+	writeDebugStream("After publish: %f, %f\n", getSetpoint(&bank, 0),
+			getSetpoint(&bank, 1));
+
+	update(&bank, processVariables);
+	print(&bank);
+}
+
+task main() {
+	newPidBank(&bank);
+	clearDebugStream();
+
+	benchUpdate();
+	testPublish();
+}
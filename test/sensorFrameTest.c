@@ -0,0 +1,47 @@
+#include "../components/sensorFrame.c"
+#include "../gyro/gyro.c"
+#include "../navigator/navigator.c"
+
+SensorFrame frame;
+
+task highRate() {
+	while (true) {
+		sampleHighRate(&frame);  // Average the gyro between frames.
+
+		sleep(1);
+	}
+}
+
+task main() {
+	newSensorFrame(&frame);
+
+	Gyro gyro;
+	newGyro(&gyro, in1);
+	calibrate(&gyro, 1000, 1);
+	registerPort(&frame, in1, true);
+
+	EncoderWheel leftEncoder;
+	newEncoderWheel(&leftEncoder, dgtl1, 360.0, 3.25);
+	registerPort(&frame, dgtl1);
+
+	EncoderWheel rightEncoder;
+	newEncoderWheel(&rightEncoder, dgtl3, 360.0, 3.25);
+	registerPort(&frame, dgtl3);
+
+	Navigator navigator;
+	newNavigator(&navigator, &leftEncoder, &rightEncoder, 7.0);
+
+	startTask(highRate);
+
+	while (true) {
+		// Read every port once, then update everything from the same instant.
+		update(&frame);
+		update(&gyro, &frame);
+		update(&navigator, &frame);
+
+		writeDebugStream("Gyro: %f; navigator: %f\n", getAngle(&gyro),
+				radiansToDegrees(getHeading(&navigator)));
+
+		sleep(15);
+	}
+}
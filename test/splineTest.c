@@ -0,0 +1,149 @@
+#include "../trajectory/spline.c"
+#include "../trajectory/hermiteSpline.c"
+#include "../trajectory/path.c"
+
+#define SAMPLE_COUNT	101
+#define BENCH_RUNS  	20
+
+SplinePoint points[SAMPLE_COUNT];
+SplinePoint naivePoints[SAMPLE_COUNT];
+
+// Evaluate every point from scratch with pow(), re-rotating each time.
+void sampleNaive(Spline *this, SplinePoint *points, short count) {
+	float h = this->knotDistance / (count - 1);
+
+	for (short i = 0; i < count; i++) {
+		float x = i * h;
+		float y = this->a * pow(x, 5.0) + this->b * pow(x, 4.0)
+				+ this->c * pow(x, 3.0) + this->d * pow(x, 2.0) + this->e * x;
+		float dy = 5.0 * this->a * pow(x, 4.0) + 4.0 * this->b * pow(x, 3.0)
+				+ 3.0 * this->c * pow(x, 2.0) + 2.0 * this->d * x + this->e;
+		float ddy = 20.0 * this->a * pow(x, 3.0) + 12.0 * this->b * pow(x, 2.0)
+				+ 6.0 * this->c * x + 2.0 * this->d;
+
+		points[i].x = this->xOffset + x * cos(this->thetaOffset)
+				- y * sin(this->thetaOffset);
+		points[i].y = this->yOffset + x * sin(this->thetaOffset)
+				+ y * cos(this->thetaOffset);
+		points[i].heading = boundAngle0To2PiRadians(this->thetaOffset + atan(dy));
+		points[i].curvature = ddy / pow(1.0 + pow(dy, 2.0), 1.5);
+	}
+}
+
+void testSampleAtDistance(Spline *spline) {
+	// Sample the spline every inch along its length.
+	SplinePoint point;
+	for (float distance = 0.0; distance <= getArcLength(spline); distance += 1.0) {
+		getPointAtDistance(spline, distance, &point);
+		print(&point);
+	}
+}
+
+void benchSample(Spline *spline) {
+	unsigned long start = nSysTime;
+	for (short i = 0; i < BENCH_RUNS; i++) {
+		sampleNaive(spline, naivePoints, SAMPLE_COUNT);
+	}
+	unsigned long naiveTime = nSysTime - start;
+
+	start = nSysTime;
+	for (short i = 0; i < BENCH_RUNS; i++) {
+		sample(spline, points, SAMPLE_COUNT);
+	}
+	unsigned long sampleTime = nSysTime - start;
+
+	float maxError = 0.0;
+	for (short i = 0; i < SAMPLE_COUNT; i++) {
+		maxError = max(maxError, fabs(points[i].x - naivePoints[i].x));
+		maxError = max(maxError, fabs(points[i].y - naivePoints[i].y));
+	}
+	writeDebugStream("%d points x %d runs\n", SAMPLE_COUNT, BENCH_RUNS);
+	writeDebugStream("Naive: %d ms\n", naiveTime);
+	writeDebugStream("Forward differencing: %d ms\n", sampleTime);
+	writeDebugStream("Max position error: %f\n", maxError);
+}
+
+void printKnotError(SplinePoint *point, float heading, float curvature) {
+	writeDebugStream("Heading: %f (want %f); curvature: %f (want %f)\n",
+			point->heading, heading, point->curvature, curvature);
+	writeDebugStream("Error: heading=%f; curvature=%f\n",
+			fabs(getDifferenceInAngleRadians(heading, point->heading)),
+			fabs(point->curvature - curvature));
+}
+
+/**
+ * Build a HermiteSpline from knots that newSpline() rejects, and check that
+ * it leaves and arrives with the requested heading and curvature.
+ */
+void testHermite(float x0, float y0, float theta0, float k0, float x1,
+		float y1, float theta1, float k1) {
+	Spline spline;
+	HermiteSpline hermite;
+	SplinePoint point;
+
+	writeDebugStream("newSpline: %s\n", newSpline(&spline, x0, y0, theta0, x1,
+			y1, theta1) ? "accepted" : "rejected");
+	if (newHermiteSpline(&hermite, x0, y0, theta0, k0, x1, y1, theta1, k1)
+			== NULL) {
+		writeDebugStream("newHermiteSpline: rejected\n");
+		return;
+	}
+	print(&hermite);
+
+	getPoint(&hermite, 0.0, &point);
+	printKnotError(&point, theta0, k0);
+	getPoint(&hermite, 1.0, &point);
+	writeDebugStream("End: (%f, %f) (want (%f, %f))\n", point.x, point.y, x1,
+			y1);
+	printKnotError(&point, theta1, k1);
+}
+
+/**
+ * Build a path through turns newSpline() rejects, and project points on it
+ * back onto it. The projected distance should match the distance sampled.
+ */
+void testHermitePath() {
+	WaypointSequence sequence;
+	newWaypointSequence(&sequence);
+	addWaypoint(&sequence, 0.0, 0.0, 0.0);
+	addWaypoint(&sequence, 24.0, 24.0, PI / 2.0);
+	addWaypoint(&sequence, 0.0, 48.0, PI);
+
+	Path path;
+	if (newPath(&path, &sequence) == NULL) {
+		writeDebugStream("newPath: rejected\n");
+		return;
+	}
+	print(&path);
+	for (short i = 0; i < getSize(&path); i++) {
+		writeDebugStream("Segment %d: %s\n", i,
+				isHermiteSegment(&path, i) ? "HermiteSpline" : "Spline");
+	}
+	PathProjection projection;
+	newPathProjection(&projection);
+	SplinePoint point;
+	float maxError = 0.0;
+
+	for (float distance = 0.0; distance <= getLength(&path); distance += 1.0) {
+		getPointAtDistance(&path, distance, &point);
+		project(&path, &projection, point.x, point.y, point.heading);
+		maxError = max(maxError, fabs(projection.distance - distance));
+	}
+	writeDebugStream("Max projected distance error: %f\n", maxError);
+}
+
+task main() {
+	Spline spline;
+	newSpline(&spline, 0.0, 0.0, 0.0, 10.0, 0.0, 0.7);
+	clearDebugStream();
+	print(&spline);
+
+	testSampleAtDistance(&spline);
+	benchSample(&spline);
+
+	// Start heading 90 degrees from the chord.
+	testHermite(0.0, 0.0, PI / 2.0, 0.05, 10.0, 0.0, 0.0, -0.1);
+	// Turn of 180 degrees.
+	testHermite(0.0, 0.0, 0.0, 0.1, 10.0, 10.0, PI, 0.0);
+	testHermitePath();
+}
@@ -0,0 +1,119 @@
+// Trajectory generator. Builds a path through the waypoints below,
+// time-parameterizes it, and writes it to the debug stream as a const table
+// for trajectory/trajectory.c. Run it in the PC emulator, save the debug
+// stream to a .c file, and include that file in the robot program so
+// autonomous starts with no path generation and no splines in RAM.
+//
+// With COMPACT_OUTPUT set, the table is instead written in the
+// delta-encoded format read by trajectory/compactTrajectory.c, followed by a
+// size and accuracy report.
+
+#include "../motionProfile/pathProfile.c"
+#include "../trajectory/path.c"
+#include "../trajectory/compactTrajectory.c"
+#include "../trajectory/trajectory.c"
+
+#define TRAJECTORY_NAME	"autonomousTrajectory"
+#define DT             	0.01  // s.
+#define MAX_VEL        	40.0  // in/s.
+#define MAX_ACC        	80.0  // in/s^2.
+#define MAX_WHEEL_VEL  	48.0  // in/s.
+#define DRIVE_WIDTH    	14.0  // in.
+#define PROFILE_POINTS 	PATHPROFILE_MAX_POINTS
+#define COMPACT_OUTPUT 	false
+
+void printSample(SplinePoint *point, float position, float velocity,
+		float acceleration) {
+	writeDebugStream("\t%f, %f, %f, %f, %f, %f, %f,\n", point->x, point->y,
+			point->heading, point->curvature, position, velocity, acceleration);
+}
+
+/**
+ * Write a time-parameterized trajectory along a path.
+ *
+ * @param 	path   	Path to follow.
+ * @param 	profile	Velocity profile planned along the path.
+ * @param 	dt     	Time between samples (s).
+ *
+ * @return	Number of samples written.
+ */
+short generate(Path *path, PathProfile *profile, float dt) {
+	float duration = getDuration(profile);
+	float position, velocity, acceleration;
+	short size = 0;
+	SplinePoint point;
+
+	writeDebugStream("const float %s[] = {\n", TRAJECTORY_NAME);
+
+	for (float t = 0.0; t < duration + dt; t += dt) {
+		sample(profile, t, &position, &velocity, &acceleration);
+		getPointAtDistance(path, position, &point);
+		printSample(&point, position, velocity, acceleration);
+		size++;
+	}
+	writeDebugStream("};\n");
+	writeDebugStream("#define %sSize %d\n", TRAJECTORY_NAME, size);
+
+	return size;
+}
+
+/**
+ * Write a time-parameterized trajectory along a path in the compact format.
+ *
+ * @param 	path   	Path to follow.
+ * @param 	profile	Velocity profile planned along the path.
+ * @param 	dt     	Time between samples (s).
+ *
+ * @return	Number of samples written.
+ */
+short generateCompact(Path *path, PathProfile *profile, float dt) {
+	float duration = getDuration(profile);
+	SplinePoint point;
+	TrajectoryPoint trajectoryPoint;
+	CompactTrajectoryWriter writer;
+	newCompactTrajectoryWriter(&writer);
+
+	writeDebugStream("const unsigned char %s[] = {\n", TRAJECTORY_NAME);
+
+	for (float t = 0.0; t < duration + dt; t += dt) {
+		sample(profile, t, &trajectoryPoint.position, &trajectoryPoint.velocity,
+				&trajectoryPoint.acceleration);
+		getPointAtDistance(path, trajectoryPoint.position, &point);
+		trajectoryPoint.x = point.x;
+		trajectoryPoint.y = point.y;
+		trajectoryPoint.heading = point.heading;
+		trajectoryPoint.curvature = point.curvature;
+		write(&writer, &trajectoryPoint);
+	}
+	writeDebugStream("\n};\n");
+	writeDebugStream("#define %sLength %d\n", TRAJECTORY_NAME, writer.bytes);
+	writeDebugStream("/*\n");
+	print(&writer);
+	writeDebugStream("*/\n");
+
+	return writer.samples;
+}
+
+task main() {
+	WaypointSequence sequence;
+	newWaypointSequence(&sequence);
+	addWaypoint(&sequence, 0.0, 0.0, 0.0);
+	addWaypoint(&sequence, 24.0, 12.0, PI / 4.0);
+	addWaypoint(&sequence, 48.0, 48.0, PI / 2.0);
+
+	Path path;
+	PathProfile profile;
+	newPathProfile(&profile, MAX_VEL, MAX_ACC, MAX_WHEEL_VEL, DRIVE_WIDTH);
+
+	clearDebugStream();
+	if (newPath(&path, &sequence) == NULL) {
+		writeDebugStream("Could not build path.\n");
+		return;
+	}
+	plan(&profile, &path, 0.0, 0.0, PROFILE_POINTS);
+	if (COMPACT_OUTPUT) {
+		generateCompact(&path, &profile, DT);
+	} else {
+		generate(&path, &profile, DT);
+	}
+}
@@ -0,0 +1,256 @@
+#pragma systemFile
+
+#if !defined(COMPACTTRAJECTORY_C_)
+#define COMPACTTRAJECTORY_C_
+
+// A compact trajectory stores x, y, heading, position and velocity as
+// fixed-point values. Each sample holds, per field, the change in that
+// field's delta since the previous sample: one signed byte when it fits,
+// otherwise an escape byte followed by a 16 or 32-bit little-endian value.
+// Acceleration and curvature are derived from consecutive samples.
+#define COMPACTTRAJECTORY_FIELDS        	5
+#define COMPACTTRAJECTORY_X             	0
+#define COMPACTTRAJECTORY_Y             	1
+#define COMPACTTRAJECTORY_HEADING       	2
+#define COMPACTTRAJECTORY_POSITION      	3
+#define COMPACTTRAJECTORY_VELOCITY      	4
+
+#define COMPACTTRAJECTORY_ESCAPE_SHORT  	-128
+#define COMPACTTRAJECTORY_ESCAPE_LONG   	-127
+
+#define COMPACTTRAJECTORY_DISTANCE_SCALE	100.0    // Units of 0.01 in.
+#define COMPACTTRAJECTORY_HEADING_SCALE 	10000.0  // Units of 0.0001 rad.
+#define COMPACTTRAJECTORY_VELOCITY_SCALE	100.0    // Units of 0.01 in/s.
+
+#include "../util/math.c"
+#include "./trajectory.c"
+
+float getCompactScale(short field) {
+	if (field == COMPACTTRAJECTORY_HEADING) {
+		return COMPACTTRAJECTORY_HEADING_SCALE;
+	} else if (field == COMPACTTRAJECTORY_VELOCITY) {
+		return COMPACTTRAJECTORY_VELOCITY_SCALE;
+	}
+	return COMPACTTRAJECTORY_DISTANCE_SCALE;
+}
+
+// Streaming decoder. Holds only the running values and deltas, so there is
+// no decompression buffer.
+typedef struct {
+	const unsigned char *data;
+	long length;  // Bytes.
+	float dt;     // Time between samples (s).
+
+	long offset;
+	short index;
+	long values[COMPACTTRAJECTORY_FIELDS];
+	long deltas[COMPACTTRAJECTORY_FIELDS];
+
+	float curvature;
+} CompactTrajectoryReader;
+
+CompactTrajectoryReader *newCompactTrajectoryReader(
+		CompactTrajectoryReader *this, const unsigned char *data, long length,
+		float dt) {
+	if (this) {
+		this->data = data;
+		this->length = length;
+		this->dt = dt;
+
+		this->offset = 0;
+		this->index = 0;
+		for (short i = 0; i < COMPACTTRAJECTORY_FIELDS; i++) {
+			this->values[i] = 0;
+			this->deltas[i] = 0;
+		}
+		this->curvature = 0.0;
+	}
+	return this;
+}
+
+bool hasNext(CompactTrajectoryReader *this) {
+	return this ? this->offset < this->length : false;
+}
+
+short getIndex(CompactTrajectoryReader *this) {
+	return this ? this->index : 0;
+}
+
+long readCompactByte(CompactTrajectoryReader *this) {
+	return this->data[this->offset++];
+}
+
+long readCompactValue(CompactTrajectoryReader *this) {
+	long b = readCompactByte(this);
+
+	if (b > 127) {
+		b -= 256;
+	}
+	if (b != COMPACTTRAJECTORY_ESCAPE_SHORT && b != COMPACTTRAJECTORY_ESCAPE_LONG) {
+		return b;
+	}
+	// Little-endian, one byte at a time so the reads happen in order.
+	short bytes = (b == COMPACTTRAJECTORY_ESCAPE_SHORT) ? 2 : 4;
+	long v = 0;
+
+	for (short i = 0; i < bytes; i++) {
+		v |= readCompactByte(this) << (8 * i);
+	}
+	if (bytes == 2 && v > 32767) {
+		v -= 65536;
+	}
+	return v;
+}
+
+/**
+ * Decode the next sample. Constant time per sample.
+ *
+ * @param 	this 	Pointer to CompactTrajectoryReader struct.
+ * @param 	point	Pointer to TrajectoryPoint struct to store the sample in.
+ *
+ * @return	true if a sample was decoded, false at the end of the data.
+ */
+bool next(CompactTrajectoryReader *this, TrajectoryPoint *point) {
+	if (!hasNext(this) || point == NULL) {
+		return false;
+	}
+	long lastPosition = this->values[COMPACTTRAJECTORY_POSITION];
+	long lastHeading = this->values[COMPACTTRAJECTORY_HEADING];
+	long lastVelocity = this->values[COMPACTTRAJECTORY_VELOCITY];
+
+	for (short i = 0; i < COMPACTTRAJECTORY_FIELDS; i++) {
+		this->deltas[i] += readCompactValue(this);
+		this->values[i] += this->deltas[i];
+	}
+	point->x = this->values[COMPACTTRAJECTORY_X] / COMPACTTRAJECTORY_DISTANCE_SCALE;
+	point->y = this->values[COMPACTTRAJECTORY_Y] / COMPACTTRAJECTORY_DISTANCE_SCALE;
+	point->heading = boundAngle0To2PiRadians(
+			this->values[COMPACTTRAJECTORY_HEADING] / COMPACTTRAJECTORY_HEADING_SCALE);
+	point->position = this->values[COMPACTTRAJECTORY_POSITION]
+			/ COMPACTTRAJECTORY_DISTANCE_SCALE;
+	point->velocity = this->values[COMPACTTRAJECTORY_VELOCITY]
+			/ COMPACTTRAJECTORY_VELOCITY_SCALE;
+
+	if (this->index == 0) {
+		point->acceleration = 0.0;
+	} else {
+		point->acceleration = (this->values[COMPACTTRAJECTORY_VELOCITY]
+				- lastVelocity) / COMPACTTRAJECTORY_VELOCITY_SCALE / this->dt;
+
+		long ds = this->values[COMPACTTRAJECTORY_POSITION] - lastPosition;
+		// Keep the last curvature while stopped.
+		if (ds != 0) {
+			this->curvature = (this->values[COMPACTTRAJECTORY_HEADING] - lastHeading)
+					/ COMPACTTRAJECTORY_HEADING_SCALE
+					/ (ds / COMPACTTRAJECTORY_DISTANCE_SCALE);
+		}
+	}
+	point->curvature = this->curvature;
+	this->index++;
+
+	return true;
+}
+
+// Encoder. Writes bytes to the debug stream as a const table, and tracks size
+// and quantization error for a report.
+typedef struct {
+	long values[COMPACTTRAJECTORY_FIELDS];
+	long deltas[COMPACTTRAJECTORY_FIELDS];
+	float lastHeading;
+
+	short samples;
+	long bytes;
+	float maxErrors[COMPACTTRAJECTORY_FIELDS];
+} CompactTrajectoryWriter;
+
+CompactTrajectoryWriter *newCompactTrajectoryWriter(
+		CompactTrajectoryWriter *this) {
+	if (this) {
+		for (short i = 0; i < COMPACTTRAJECTORY_FIELDS; i++) {
+			this->values[i] = 0;
+			this->deltas[i] = 0;
+			this->maxErrors[i] = 0.0;
+		}
+		this->lastHeading = 0.0;
+
+		this->samples = 0;
+		this->bytes = 0;
+	}
+	return this;
+}
+
+void writeCompactByte(CompactTrajectoryWriter *this, long b) {
+	writeDebugStream("%d,", b & 0xff);
+	if (++this->bytes % 16 == 0) {
+		writeDebugStream("\n");
+	}
+}
+
+void writeCompactValue(CompactTrajectoryWriter *this, long v) {
+	if (v > COMPACTTRAJECTORY_ESCAPE_LONG && v <= 127) {
+		writeCompactByte(this, v);
+	} else if (v >= -32768 && v <= 32767) {
+		writeCompactByte(this, COMPACTTRAJECTORY_ESCAPE_SHORT);
+		writeCompactByte(this, v);
+		writeCompactByte(this, v >> 8);
+	} else {
+		writeCompactByte(this, COMPACTTRAJECTORY_ESCAPE_LONG);
+		writeCompactByte(this, v);
+		writeCompactByte(this, v >> 8);
+		writeCompactByte(this, v >> 16);
+		writeCompactByte(this, v >> 24);
+	}
+}
+
+/**
+ * Encode a sample.
+ *
+ * @param 	this 	Pointer to CompactTrajectoryWriter struct.
+ * @param 	point	Sample to encode.
+ */
+void write(CompactTrajectoryWriter *this, TrajectoryPoint *point) {
+	if (this == NULL || point == NULL) {
+		return;
+	}
+	float fields[COMPACTTRAJECTORY_FIELDS];
+	fields[COMPACTTRAJECTORY_X] = point->x;
+	fields[COMPACTTRAJECTORY_Y] = point->y;
+	// Unwrap heading so it never jumps by 2 Pi between samples.
+	fields[COMPACTTRAJECTORY_HEADING] = this->lastHeading
+			+ getDifferenceInAngleRadians(this->lastHeading, point->heading);
+	fields[COMPACTTRAJECTORY_POSITION] = point->position;
+	fields[COMPACTTRAJECTORY_VELOCITY] = point->velocity;
+	this->lastHeading = fields[COMPACTTRAJECTORY_HEADING];
+
+	for (short i = 0; i < COMPACTTRAJECTORY_FIELDS; i++) {
+		float scale = getCompactScale(i);
+		long value = round(fields[i] * scale);
+		long delta = value - this->values[i];
+
+		writeCompactValue(this, delta - this->deltas[i]);
+		this->deltas[i] = delta;
+		this->values[i] = value;
+		this->maxErrors[i] = max(this->maxErrors[i],
+				fabs(fields[i] - value / scale));
+	}
+	this->samples++;
+}
+
+void print(CompactTrajectoryWriter *this) {
+	if (this == NULL) {
+		return;
+	}
+	long rawBytes = (long)this->samples * TRAJECTORY_STRIDE * sizeof(float);
+
+	writeDebugStream("Samples: %d\n", this->samples);
+	writeDebugStream("Compact size: %d bytes (%f per sample)\n", this->bytes,
+			(float)this->bytes / this->samples);
+	writeDebugStream("Float table size: %d bytes\n", rawBytes);
+	writeDebugStream("Max error: x=%f; y=%f; heading=%f; position=%f; velocity=%f\n",
+			this->maxErrors[COMPACTTRAJECTORY_X], this->maxErrors[COMPACTTRAJECTORY_Y],
+			this->maxErrors[COMPACTTRAJECTORY_HEADING],
+			this->maxErrors[COMPACTTRAJECTORY_POSITION],
+			this->maxErrors[COMPACTTRAJECTORY_VELOCITY]);
+}
+
+#endif  // COMPACTTRAJECTORY_C_
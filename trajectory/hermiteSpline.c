@@ -0,0 +1,374 @@
+#pragma systemFile
+
+#if !defined(HERMITESPLINE_C_)
+#define HERMITESPLINE_C_
+
+#include "../util/math.c"
+#include "./spline.c"
+#include "./waypoint.c"
+
+// Parametric quintic Hermite spline, x(t) and y(t) for t in [0, 1]. Unlike
+// Spline, it accepts any heading at either knot. Matching curvature at a
+// shared knot gives G2 (curvature) continuity; the parameterization is not
+// shared between segments, so it is not C2.
+typedef struct {
+	float ax;  // ax*t^5
+	float bx;  // + bx*t^4
+	float cx;  // + cx*t^3
+	float dx;  // + dx*t^2
+	float ex;  // + ex*t
+	float fx;  // + fx
+
+	float ay;
+	float by;
+	float cy;
+	float dy;
+	float ey;
+	float fy;
+
+	float arcLength;
+
+	// Cumulative arc length at SPLINE_TABLE_SIZE even steps of t.
+	float lengths[SPLINE_TABLE_SIZE + 1];
+} HermiteSpline;
+
+/**
+ * Set the power basis coefficients for one axis from the knot values.
+ *
+ * @param 	coefficients	Array of 6 coefficients, highest power first.
+ * @param 	p0          	Position at t = 0.
+ * @param 	v0          	First derivative at t = 0.
+ * @param 	a0          	Second derivative at t = 0.
+ * @param 	p1          	Position at t = 1.
+ * @param 	v1          	First derivative at t = 1.
+ * @param 	a1          	Second derivative at t = 1.
+ */
+void setHermiteCoefficients(float *coefficients, float p0, float v0, float a0,
+		float p1, float v1, float a1) {
+	coefficients[0] = -6.0 * p0 - 3.0 * v0 - 0.5 * a0 + 0.5 * a1 - 3.0 * v1
+			+ 6.0 * p1;
+	coefficients[1] = 15.0 * p0 + 8.0 * v0 + 1.5 * a0 - a1 + 7.0 * v1
+			- 15.0 * p1;
+	coefficients[2] = -10.0 * p0 - 6.0 * v0 - 1.5 * a0 + 0.5 * a1 - 4.0 * v1
+			+ 10.0 * p1;
+	coefficients[3] = 0.5 * a0;
+	coefficients[4] = v0;
+	coefficients[5] = p0;
+}
+
+float getXDerivative(HermiteSpline *this, float t) {
+	return (((5.0 * this->ax * t + 4.0 * this->bx) * t + 3.0 * this->cx) * t
+			+ 2.0 * this->dx) * t + this->ex;
+}
+
+float getYDerivative(HermiteSpline *this, float t) {
+	return (((5.0 * this->ay * t + 4.0 * this->by) * t + 3.0 * this->cy) * t
+			+ 2.0 * this->dy) * t + this->ey;
+}
+
+float getXSecondDerivative(HermiteSpline *this, float t) {
+	return ((20.0 * this->ax * t + 12.0 * this->bx) * t + 6.0 * this->cx) * t
+			+ 2.0 * this->dx;
+}
+
+float getYSecondDerivative(HermiteSpline *this, float t) {
+	return ((20.0 * this->ay * t + 12.0 * this->by) * t + 6.0 * this->cy) * t
+			+ 2.0 * this->dy;
+}
+
+float integrateArcLength(HermiteSpline *this, float t0, float t1) {
+	float halfWidth = (t1 - t0) / 2.0;
+	float center = (t1 + t0) / 2.0;
+	float sum = 0.0;
+
+	for (short i = 0; i < 5; i++) {
+		float t = center + halfWidth * splineGaussAbscissae[i];
+		float dx = getXDerivative(this, t);
+		float dy = getYDerivative(this, t);
+
+		sum += splineGaussWeights[i] * sqrt(dx * dx + dy * dy);
+	}
+	return sum * halfWidth;
+}
+
+void computeArcLength(HermiteSpline *this) {
+	float step = 1.0 / SPLINE_TABLE_SIZE;
+
+	this->lengths[0] = 0.0;
+	for (short i = 0; i < SPLINE_TABLE_SIZE; i++) {
+		this->lengths[i + 1] = this->lengths[i]
+				+ integrateArcLength(this, i * step, (i + 1) * step);
+	}
+	this->arcLength = this->lengths[SPLINE_TABLE_SIZE];
+}
+
+/**
+ * Initialize Hermite spline.
+ *
+ * @param 	this  	Pointer to HermiteSpline struct.
+ * @param 	x0    	Start x.
+ * @param 	y0    	Start y.
+ * @param 	theta0	Start heading (radians).
+ * @param 	k0    	Start curvature.
+ * @param 	x1    	End x.
+ * @param 	y1    	End y.
+ * @param 	theta1	End heading (radians).
+ * @param 	k1    	End curvature.
+ *
+ * @return	Pointer to HermiteSpline struct, or NULL if the knots coincide.
+ */
+HermiteSpline *newHermiteSpline(HermiteSpline *this, float x0, float y0,
+		float theta0, float k0, float x1, float y1, float theta1, float k1) {
+	if (this == NULL) {
+		return NULL;
+	}
+	// Tangent magnitude of the chord length keeps the parameterization close
+	// to arc length for gentle curves.
+	float scale = sqrt(pow(x1 - x0, 2.0) + pow(y1 - y0, 2.0));
+
+	if (scale == 0.0) {
+		return NULL;
+	}
+	float cos0 = cos(theta0);
+	float sin0 = sin(theta0);
+	float cos1 = cos(theta1);
+	float sin1 = sin(theta1);
+	// Second derivative normal to the tangent gives curvature k.
+	float normal0 = k0 * scale * scale;
+	float normal1 = k1 * scale * scale;
+	float coefficients[6];
+
+	setHermiteCoefficients(coefficients, x0, scale * cos0, -normal0 * sin0, x1,
+			scale * cos1, -normal1 * sin1);
+	this->ax = coefficients[0];
+	this->bx = coefficients[1];
+	this->cx = coefficients[2];
+	this->dx = coefficients[3];
+	this->ex = coefficients[4];
+	this->fx = coefficients[5];
+
+	setHermiteCoefficients(coefficients, y0, scale * sin0, normal0 * cos0, y1,
+			scale * sin1, normal1 * cos1);
+	this->ay = coefficients[0];
+	this->by = coefficients[1];
+	this->cy = coefficients[2];
+	this->dy = coefficients[3];
+	this->ey = coefficients[4];
+	this->fy = coefficients[5];
+
+	computeArcLength(this);
+
+	return this;
+}
+
+HermiteSpline *newHermiteSpline(HermiteSpline *this, float x0, float y0,
+		float theta0, float x1, float y1, float theta1) {
+	return newHermiteSpline(this, x0, y0, theta0, 0.0, x1, y1, theta1, 0.0);
+}
+
+HermiteSpline *newHermiteSpline(HermiteSpline *this, Waypoint *beginning,
+		Waypoint *end) {
+	return newHermiteSpline(this, beginning->x, beginning->y, beginning->theta,
+			end->x, end->y, end->theta);
+}
+
+float getArcLength(HermiteSpline *this) {
+	return this ? this->arcLength : 0.0;
+}
+
+/**
+ * Evaluate the spline.
+ *
+ * @param 	this 	Pointer to HermiteSpline struct.
+ * @param 	t    	Parameter, between 0 and 1.
+ * @param 	point	Pointer to SplinePoint struct to store the result in.
+ */
+void getPoint(HermiteSpline *this, float t, SplinePoint *point) {
+	if (this == NULL || point == NULL) {
+		return;
+	}
+	float dx = getXDerivative(this, t);
+	float dy = getYDerivative(this, t);
+	float ddx = getXSecondDerivative(this, t);
+	float ddy = getYSecondDerivative(this, t);
+	float speedSquared = dx * dx + dy * dy;
+
+	point->x = ((((this->ax * t + this->bx) * t + this->cx) * t + this->dx) * t
+			+ this->ex) * t + this->fx;
+	point->y = ((((this->ay * t + this->by) * t + this->cy) * t + this->dy) * t
+			+ this->ey) * t + this->fy;
+	point->heading = boundAngle0To2PiRadians(atan2(dy, dx));
+	point->curvature = (speedSquared > 0.0)
+			? (dx * ddy - dy * ddx) / (speedSquared * sqrt(speedSquared)) : 0.0;
+}
+
+/**
+ * Find the parameter at a distance along the spline.
+ *
+ * @param 	this    	Pointer to HermiteSpline struct.
+ * @param 	distance	Distance along the spline.
+ *
+ * @return	Parameter, between 0 and 1.
+ */
+float getParameter(HermiteSpline *this, float distance) {
+	if (this == NULL || distance <= 0.0) {
+		return 0.0;
+	}
+	if (distance >= this->arcLength) {
+		return 1.0;
+	}
+	short low = 0;
+	short high = SPLINE_TABLE_SIZE;
+
+	while (high - low > 1) {
+		short mid = (low + high) / 2;
+
+		if (this->lengths[mid] <= distance) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+	float step = 1.0 / SPLINE_TABLE_SIZE;
+	float t0 = low * step;
+	float t = t0 + step * (distance - this->lengths[low])
+			/ (this->lengths[high] - this->lengths[low]);
+	float dx = getXDerivative(this, t);
+	float dy = getYDerivative(this, t);
+	float speed = sqrt(dx * dx + dy * dy);
+
+	if (speed > 0.0) {
+		t -= (this->lengths[low] + integrateArcLength(this, t0, t) - distance)
+				/ speed;
+	}
+	return (t < t0) ? t0 : ((t > t0 + step) ? t0 + step : t);
+}
+
+void getPointAtDistance(HermiteSpline *this, float distance,
+		SplinePoint *point) {
+	getPoint(this, getParameter(this, distance), point);
+}
+
+/**
+ * Find the distance along the spline to a parameter.
+ *
+ * @param 	this	Pointer to HermiteSpline struct.
+ * @param 	t   	Parameter, between 0 and 1.
+ *
+ * @return	Distance along the spline.
+ */
+float getDistanceAtParameter(HermiteSpline *this, float t) {
+	if (this == NULL || t <= 0.0) {
+		return 0.0;
+	}
+	if (t >= 1.0) {
+		return this->arcLength;
+	}
+	float step = 1.0 / SPLINE_TABLE_SIZE;
+	short i = (short)(t / step);
+
+	return this->lengths[i] + integrateArcLength(this, i * step, t);
+}
+
+/**
+ * Take up to iterations Newton steps toward the parameter of the point
+ * closest to (px, py).
+ *
+ * @return	Closest parameter found, between 0 and 1.
+ */
+float refineProjection(HermiteSpline *this, float px, float py, float t,
+		short iterations) {
+	for (short i = 0; i < iterations; i++) {
+		float x = ((((this->ax * t + this->bx) * t + this->cx) * t + this->dx) * t
+				+ this->ex) * t + this->fx - px;
+		float y = ((((this->ay * t + this->by) * t + this->cy) * t + this->dy) * t
+				+ this->ey) * t + this->fy - py;
+		float dx = getXDerivative(this, t);
+		float dy = getYDerivative(this, t);
+		// Derivatives of half the squared distance to (px, py).
+		float gradient = x * dx + y * dy;
+		float speedSquared = dx * dx + dy * dy;
+		float hessian = speedSquared + x * getXSecondDerivative(this, t)
+				+ y * getYSecondDerivative(this, t);
+
+		if (hessian <= 0.0) {
+			hessian = speedSquared;  // Not convex here, fall back to a scaled gradient step.
+		}
+		if (hessian <= 0.0) {
+			break;
+		}
+		float step = gradient / hessian;
+
+		t -= step;
+		if (t < 0.0) {
+			t = 0.0;
+		} else if (t > 1.0) {
+			t = 1.0;
+		}
+		if (fabs(step) < 0.00001) {
+			break;
+		}
+	}
+	return t;
+}
+
+/**
+ * Find the point on the spline closest to (x, y). Starts Newton's method from
+ * guess, and if that does not settle, restarts it from the closest arc length
+ * table knot, so the cost is bounded either way.
+ *
+ * @param 	this 	Pointer to HermiteSpline struct.
+ * @param 	x    	World x.
+ * @param 	y    	World y.
+ * @param 	guess	Starting parameter, e.g. last tick's result.
+ *
+ * @return	Closest parameter, between 0 and 1.
+ */
+float project(HermiteSpline *this, float x, float y, float guess) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	SplinePoint point;
+	float result = refineProjection(this, x, y, guess, 4);
+
+	getPoint(this, result, &point);
+	float dx = getXDerivative(this, result);
+	float dy = getYDerivative(this, result);
+	float speed = sqrt(dx * dx + dy * dy);
+	// Gradient per unit of arc length, so the test matches Spline's.
+	float gradient = (speed > 0.0)
+			? ((point.x - x) * dx + (point.y - y) * dy) / speed : 0.0;
+
+	// Settled at an interior minimum or pinned against an end.
+	if (fabs(gradient) < 0.001 || (result == 0.0 && gradient > 0.0)
+			|| (result == 1.0 && gradient < 0.0)) {
+		return result;
+	}
+	float step = 1.0 / SPLINE_TABLE_SIZE;
+	float best = 0.0;
+	float bestDistance = -1.0;
+
+	for (short i = 0; i <= SPLINE_TABLE_SIZE; i++) {
+		getPoint(this, i * step, &point);
+		float distance = pow(point.x - x, 2.0) + pow(point.y - y, 2.0);
+
+		if (bestDistance < 0.0 || distance < bestDistance) {
+			best = i * step;
+			bestDistance = distance;
+		}
+	}
+	return refineProjection(this, x, y, best, 4);
+}
+
+void print(HermiteSpline *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("x: a=%f; b=%f; c=%f; d=%f; e=%f; f=%f\n", this->ax,
+			this->bx, this->cx, this->dx, this->ex, this->fx);
+	writeDebugStream("y: a=%f; b=%f; c=%f; d=%f; e=%f; f=%f\n", this->ay,
+			this->by, this->cy, this->dy, this->ey, this->fy);
+	writeDebugStream("arcLength=%f\n", this->arcLength);
+}
+
+#endif  // HERMITESPLINE_C_
@@ -0,0 +1,273 @@
+#pragma systemFile
+
+#if !defined(PATH_C_)
+#define PATH_C_
+
+#define PATH_MAX_SPLINES	8
+
+#include "./hermiteSpline.c"
+#include "./spline.c"
+#include "./waypoint.c"
+#include "./waypointSequence.c"
+
+// Each segment is a Spline, or a HermiteSpline where newSpline() rejects
+// the waypoints (a heading 90 degrees off the chord, or a turn of 90 degrees
+// or more). Both have zero curvature at the knots, so segments join with
+// continuous curvature either way.
+typedef struct {
+	short size;
+	Spline splines[PATH_MAX_SPLINES];
+	HermiteSpline hermiteSplines[PATH_MAX_SPLINES];
+	bool isHermite[PATH_MAX_SPLINES];
+	float starts[PATH_MAX_SPLINES];  // Distance at the start of each spline.
+
+	float length;
+} Path;
+
+// Result of projecting a pose onto a path. Keeps the segment and parameter
+// from the last projection so the next one can start from there. The
+// parameter is in the segment's own basis: x for a Spline, t for a
+// HermiteSpline.
+typedef struct {
+	short index;
+	float parameter;
+
+	float distance;      // Distance along the path.
+	float crossTrack;    // Distance left of the path (negative to the right).
+	float headingError;  // Path heading minus robot heading, -Pi to Pi.
+} PathProjection;
+
+Path *newPath(Path *this) {
+	if (this) {
+		this->size = 0;
+		this->length = 0.0;
+	}
+	return this;
+}
+
+/**
+ * Append a segment between two waypoints, as a Spline if newSpline() accepts
+ * them and as a HermiteSpline otherwise.
+ *
+ * @param 	this 	Pointer to Path struct.
+ * @param 	begin	Waypoint to start at.
+ * @param 	end  	Waypoint to end at.
+ *
+ * @return	Whether the segment was added. False if the path is full or the
+ *        	waypoints coincide.
+ */
+bool addSpline(Path *this, Waypoint *begin, Waypoint *end) {
+	if (this == NULL || this->size >= PATH_MAX_SPLINES) {
+		return false;
+	}
+	short i = this->size;
+	float arcLength;
+
+	if (newSpline(&this->splines[i], begin, end)) {
+		this->isHermite[i] = false;
+		arcLength = this->splines[i].arcLength;
+	} else if (newHermiteSpline(&this->hermiteSplines[i], begin, end)) {
+		this->isHermite[i] = true;
+		arcLength = this->hermiteSplines[i].arcLength;
+	} else {
+		return false;
+	}
+	this->starts[this->size++] = this->length;
+	this->length += arcLength;
+
+	return true;
+}
+
+/**
+ * Initialize path through every waypoint in a sequence.
+ *
+ * @param 	this     	Pointer to Path struct.
+ * @param 	waypoints	Waypoints to pass through, in order.
+ *
+ * @return	Pointer to Path struct, or NULL if a segment cannot be built.
+ */
+Path *newPath(Path *this, WaypointSequence *waypoints) {
+	if (newPath(this) == NULL || waypoints == NULL) {
+		return NULL;
+	}
+	for (short i = 0; i + 1 < waypoints->size; i++) {
+		if (!addSpline(this, &waypoints->waypoints[i],
+				&waypoints->waypoints[i + 1])) {
+			return NULL;
+		}
+	}
+	return this;
+}
+
+short getSize(Path *this) {
+	return this ? this->size : 0;
+}
+
+bool isHermiteSegment(Path *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? this->isHermite[index] : false;
+}
+
+/**
+ * Get a segment built as a Spline, or NULL if it is a HermiteSpline.
+ */
+Spline *getSpline(Path *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size
+			&& !this->isHermite[index]) ? &this->splines[index] : NULL;
+}
+
+/**
+ * Get a segment built as a HermiteSpline, or NULL if it is a Spline.
+ */
+HermiteSpline *getHermiteSpline(Path *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size
+			&& this->isHermite[index]) ? &this->hermiteSplines[index] : NULL;
+}
+
+/**
+ * Get the parameter at the end of a segment: knotDistance for a Spline, 1
+ * for a HermiteSpline. Both start at 0.
+ */
+float getSegmentEnd(Path *this, short index) {
+	return this->isHermite[index] ? 1.0 : this->splines[index].knotDistance;
+}
+
+void getSegmentPoint(Path *this, short index, float parameter,
+		SplinePoint *point) {
+	if (this->isHermite[index]) {
+		getPoint(&this->hermiteSplines[index], parameter, point);
+	} else {
+		getPoint(&this->splines[index], parameter, point);
+	}
+}
+
+float getSegmentDistance(Path *this, short index, float parameter) {
+	return this->isHermite[index]
+			? getDistanceAtParameter(&this->hermiteSplines[index], parameter)
+			: getDistanceAtParameter(&this->splines[index], parameter);
+}
+
+float projectSegment(Path *this, short index, float x, float y, float guess) {
+	return this->isHermite[index]
+			? project(&this->hermiteSplines[index], x, y, guess)
+			: project(&this->splines[index], x, y, guess);
+}
+
+float getLength(Path *this) {
+	return this ? this->length : 0.0;
+}
+
+/**
+ * Find the spline containing a distance along the path.
+ */
+short getSplineIndex(Path *this, float distance) {
+	if (this == NULL || this->size == 0) {
+		return -1;
+	}
+	short i = this->size - 1;
+
+	while (i > 0 && this->starts[i] > distance) {
+		i--;
+	}
+	return i;
+}
+
+void getPointAtDistance(Path *this, float distance, SplinePoint *point) {
+	short i = getSplineIndex(this, distance);
+
+	if (i < 0) {
+		return;
+	}
+	if (this->isHermite[i]) {
+		getPointAtDistance(&this->hermiteSplines[i], distance - this->starts[i],
+				point);
+	} else {
+		getPointAtDistance(&this->splines[i], distance - this->starts[i], point);
+	}
+}
+
+PathProjection *newPathProjection(PathProjection *this) {
+	if (this) {
+		this->index = 0;
+		this->parameter = 0.0;
+
+		this->distance = 0.0;
+		this->crossTrack = 0.0;
+		this->headingError = 0.0;
+	}
+	return this;
+}
+
+/**
+ * Project a pose onto the path, starting from the previous projection. Only
+ * moves to a neighbouring spline when the closest point is pinned against an
+ * end of the current one, so the cost per tick stays close to constant.
+ *
+ * @param 	this      	Pointer to Path struct.
+ * @param 	projection	Pointer to PathProjection struct holding the last
+ *        	          	projection, updated in place.
+ * @param 	x         	Robot x.
+ * @param 	y         	Robot y.
+ * @param 	heading   	Robot heading (radians, same convention as waypoints).
+ */
+void project(Path *this, PathProjection *projection, float x, float y,
+		float heading) {
+	if (this == NULL || projection == NULL || this->size == 0) {
+		return;
+	}
+	short index = projection->index;
+
+	if (index < 0 || index >= this->size) {
+		index = 0;
+	}
+	float parameter = projectSegment(this, index, x, y, projection->parameter);
+
+	for (short moves = 0; moves < this->size; moves++) {
+		if (parameter >= getSegmentEnd(this, index) && index < this->size - 1) {
+			index++;
+			parameter = projectSegment(this, index, x, y, 0.0);
+			if (parameter > 0.0) {
+				continue;
+			}
+		} else if (parameter <= 0.0 && index > 0) {
+			index--;
+			parameter = projectSegment(this, index, x, y, getSegmentEnd(this, index));
+			if (parameter < getSegmentEnd(this, index)) {
+				continue;
+			}
+		}
+		break;
+	}
+	SplinePoint point;
+
+	getSegmentPoint(this, index, parameter, &point);
+
+	projection->index = index;
+	projection->parameter = parameter;
+	projection->distance = this->starts[index]
+			+ getSegmentDistance(this, index, parameter);
+	projection->crossTrack = -(x - point.x) * sin(point.heading)
+			+ (y - point.y) * cos(point.heading);
+	projection->headingError = getDifferenceInAngleRadians(heading,
+			point.heading);
+}
+
+void print(PathProjection *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Spline: %d; parameter: %f\n", this->index, this->parameter);
+	writeDebugStream("Distance: %f\n", this->distance);
+	writeDebugStream("Cross track: %f\n", this->crossTrack);
+	writeDebugStream("Heading error: %f\n", this->headingError);
+}
+
+void print(Path *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("Splines: %d\n", this->size);
+	writeDebugStream("Length: %f\n", this->length);
+}
+
+#endif  // PATH_C_
@@ -3,6 +3,8 @@
 #if !defined(SPLINE_C_)
 #define SPLINE_C_
 
+#define SPLINE_TABLE_SIZE	16  // Arc length table intervals.
+
 #include "../util/math.c"
 #include "./waypoint.c"
 
@@ -18,12 +20,71 @@ typedef struct {
 	float knotDistance;
 	float thetaOffset;
 	float arcLength;
+
+	// Cumulative arc length at SPLINE_TABLE_SIZE even steps of knotDistance.
+	float lengths[SPLINE_TABLE_SIZE + 1];
 } Spline;
 
+typedef struct {
+	float x;
+	float y;
+	float heading;
+	float curvature;
+} SplinePoint;
+
+// 5-point Gauss-Legendre abscissae and weights on [-1, 1].
+const float splineGaussAbscissae[5] = {-0.9061798459, -0.5384693101, 0.0,
+		0.5384693101, 0.9061798459};
+const float splineGaussWeights[5] = {0.2369268851, 0.4786286705, 0.5688888889,
+		0.4786286705, 0.2369268851};
+
 bool almostEqual(float x, float y) {
 	return fabs(x - y) < 0.000001;
 }
 
+float getValue(Spline *this, float x) {
+	return ((((this->a * x + this->b) * x + this->c) * x + this->d) * x
+			+ this->e) * x;
+}
+
+float getDerivative(Spline *this, float x) {
+	return (((5.0 * this->a * x + 4.0 * this->b) * x + 3.0 * this->c) * x
+			+ 2.0 * this->d) * x + this->e;
+}
+
+float getSecondDerivative(Spline *this, float x) {
+	return ((20.0 * this->a * x + 12.0 * this->b) * x + 6.0 * this->c) * x
+			+ 2.0 * this->d;
+}
+
+/**
+ * Integrate arc length between two points in the spline's basis using
+ * 5-point Gauss-Legendre quadrature.
+ */
+float integrateArcLength(Spline *this, float x0, float x1) {
+	float halfWidth = (x1 - x0) / 2.0;
+	float center = (x1 + x0) / 2.0;
+	float sum = 0.0;
+
+	for (short i = 0; i < 5; i++) {
+		float dy = getDerivative(this, center + halfWidth * splineGaussAbscissae[i]);
+
+		sum += splineGaussWeights[i] * sqrt(1.0 + dy * dy);
+	}
+	return sum * halfWidth;
+}
+
+void computeArcLength(Spline *this) {
+	float step = this->knotDistance / SPLINE_TABLE_SIZE;
+
+	this->lengths[0] = 0.0;
+	for (short i = 0; i < SPLINE_TABLE_SIZE; i++) {
+		this->lengths[i + 1] = this->lengths[i]
+				+ integrateArcLength(this, i * step, (i + 1) * step);
+	}
+	this->arcLength = this->lengths[SPLINE_TABLE_SIZE];
+}
+
 Spline *newSpline(Spline *this, float x0, float y0, float theta0, float x1,
 		float y1, float theta1) {
 	// Transform to the origin.
@@ -59,6 +120,8 @@ Spline *newSpline(Spline *this, float x0, float y0, float theta0, float x1,
 	this->d = 0.0;
 	this->e = yp0Hat;
 
+	computeArcLength(this);
+
 	return this;
 }
 
@@ -67,6 +130,265 @@ Spline *newSpline(Spline *this, Waypoint *beginning, Waypoint *end) {
 			end->y, end->theta);
 }
 
+float getArcLength(Spline *this) {
+	return this ? this->arcLength : 0.0;
+}
+
+float getKnotDistance(Spline *this) {
+	return this ? this->knotDistance : 0.0;
+}
+
+/**
+ * Find the point in the spline's basis at a distance along the spline.
+ *
+ * @param 	this    	Pointer to Spline struct.
+ * @param 	distance	Distance along the spline.
+ *
+ * @return	x in the spline's basis, between 0 and knotDistance.
+ */
+float getParameter(Spline *this, float distance) {
+	if (this == NULL || distance <= 0.0) {
+		return 0.0;
+	}
+	if (distance >= this->arcLength) {
+		return this->knotDistance;
+	}
+	// Binary search the table for the interval containing distance.
+	short low = 0;
+	short high = SPLINE_TABLE_SIZE;
+
+	while (high - low > 1) {
+		short mid = (low + high) / 2;
+
+		if (this->lengths[mid] <= distance) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+	float step = this->knotDistance / SPLINE_TABLE_SIZE;
+	float x0 = low * step;
+	float x = x0 + step * (distance - this->lengths[low])
+			/ (this->lengths[high] - this->lengths[low]);
+	// One Newton step on s(x) - distance, where ds/dx = sqrt(1 + y'^2).
+	float dy = getDerivative(this, x);
+
+	x -= (this->lengths[low] + integrateArcLength(this, x0, x) - distance)
+			/ sqrt(1.0 + dy * dy);
+
+	return (x < x0) ? x0 : ((x > x0 + step) ? x0 + step : x);
+}
+
+/**
+ * Evaluate the spline at a point in its basis.
+ *
+ * @param 	this 	Pointer to Spline struct.
+ * @param 	x    	x in the spline's basis, between 0 and knotDistance.
+ * @param 	point	Pointer to SplinePoint struct to store the result in.
+ */
+void getPoint(Spline *this, float x, SplinePoint *point) {
+	if (this == NULL || point == NULL) {
+		return;
+	}
+	float y = getValue(this, x);
+	float dy = getDerivative(this, x);
+	float ddy = getSecondDerivative(this, x);
+	float cosTheta = cos(this->thetaOffset);
+	float sinTheta = sin(this->thetaOffset);
+
+	point->x = this->xOffset + x * cosTheta - y * sinTheta;
+	point->y = this->yOffset + x * sinTheta + y * cosTheta;
+	point->heading = boundAngle0To2PiRadians(this->thetaOffset + atan(dy));
+	point->curvature = ddy / pow(1.0 + dy * dy, 1.5);
+}
+
+void getPointAtDistance(Spline *this, float distance, SplinePoint *point) {
+	getPoint(this, getParameter(this, distance), point);
+}
+
+/**
+ * Find the distance along the spline to a point in its basis.
+ *
+ * @param 	this	Pointer to Spline struct.
+ * @param 	x   	x in the spline's basis, between 0 and knotDistance.
+ *
+ * @return	Distance along the spline.
+ */
+float getDistanceAtParameter(Spline *this, float x) {
+	if (this == NULL || x <= 0.0) {
+		return 0.0;
+	}
+	if (x >= this->knotDistance) {
+		return this->arcLength;
+	}
+	float step = this->knotDistance / SPLINE_TABLE_SIZE;
+	short i = (short)(x / step);
+
+	return this->lengths[i] + integrateArcLength(this, i * step, x);
+}
+
+/**
+ * Take up to iterations Newton steps toward the point in the spline's basis
+ * closest to (px, py), where (px, py) is also in the spline's basis.
+ *
+ * @return	Closest x found, between 0 and knotDistance.
+ */
+float refineProjection(Spline *this, float px, float py, float x,
+		short iterations) {
+	for (short i = 0; i < iterations; i++) {
+		float y = getValue(this, x) - py;
+		float dy = getDerivative(this, x);
+		// Derivatives of half the squared distance to (px, py).
+		float gradient = (x - px) + y * dy;
+		float hessian = 1.0 + dy * dy + y * getSecondDerivative(this, x);
+
+		if (hessian <= 0.0) {
+			hessian = 1.0 + dy * dy;  // Not convex here, fall back to a scaled gradient step.
+		}
+		float step = gradient / hessian;
+
+		x -= step;
+		if (x < 0.0) {
+			x = 0.0;
+		} else if (x > this->knotDistance) {
+			x = this->knotDistance;
+		}
+		if (fabs(step) < 0.0001) {
+			break;
+		}
+	}
+	return x;
+}
+
+/**
+ * Find the point on the spline closest to (x, y). Starts Newton's method from
+ * guess, and if that does not settle, restarts it from the closest arc length
+ * table knot, so the cost is bounded either way.
+ *
+ * @param 	this 	Pointer to Spline struct.
+ * @param 	x    	World x.
+ * @param 	y    	World y.
+ * @param 	guess	Starting x in the spline's basis, e.g. last tick's result.
+ *
+ * @return	Closest x in the spline's basis, between 0 and knotDistance.
+ */
+float project(Spline *this, float x, float y, float guess) {
+	if (this == NULL) {
+		return 0.0;
+	}
+	float cosTheta = cos(this->thetaOffset);
+	float sinTheta = sin(this->thetaOffset);
+	float dx = x - this->xOffset;
+	float dy = y - this->yOffset;
+	float px = dx * cosTheta + dy * sinTheta;
+	float py = -dx * sinTheta + dy * cosTheta;
+	float result = refineProjection(this, px, py, guess, 4);
+	float gradient = (result - px) + (getValue(this, result) - py)
+			* getDerivative(this, result);
+
+	// Settled at an interior minimum or pinned against an end.
+	if (fabs(gradient) < 0.001 || (result == 0.0 && gradient > 0.0)
+			|| (result == this->knotDistance && gradient < 0.0)) {
+		return result;
+	}
+	float step = this->knotDistance / SPLINE_TABLE_SIZE;
+	float best = 0.0;
+	float bestDistance = -1.0;
+
+	for (short i = 0; i <= SPLINE_TABLE_SIZE; i++) {
+		float knot = i * step;
+		float distance = pow(knot - px, 2.0) + pow(getValue(this, knot) - py, 2.0);
+
+		if (bestDistance < 0.0 || distance < bestDistance) {
+			best = knot;
+			bestDistance = distance;
+		}
+	}
+	return refineProjection(this, px, py, best, 4);
+}
+
+/**
+ * Load forward differences for a polynomial from its values at n + 1 evenly
+ * spaced points.
+ */
+void initDifferences(float *differences, short n) {
+	for (short order = 1; order <= n; order++) {
+		for (short i = n; i >= order; i--) {
+			differences[i] -= differences[i - 1];
+		}
+	}
+}
+
+/**
+ * Step forward differences to the next point.
+ */
+void stepDifferences(float *differences, short n) {
+	for (short i = 0; i < n; i++) {
+		differences[i] += differences[i + 1];
+	}
+}
+
+/**
+ * Sample the spline at evenly spaced points in its basis, from 0 to
+ * knotDistance inclusive, using forward differencing. After setup, each
+ * point costs a dozen adds plus the atan and sqrt for heading and
+ * curvature.
+ *
+ * @param 	this  	Pointer to Spline struct.
+ * @param 	points	Array of at least count SplinePoint structs.
+ * @param 	count 	Number of points to sample (at least 2).
+ *
+ * @return	Number of points written.
+ */
+short sample(Spline *this, SplinePoint *points, short count) {
+	if (this == NULL || points == NULL || count < 2) {
+		return 0;
+	}
+	float h = this->knotDistance / (count - 1);
+	// Differences for y (quintic), y' (quartic) and y'' (cubic).
+	float y[6];
+	float dy[5];
+	float ddy[4];
+
+	for (short i = 0; i < 6; i++) {
+		y[i] = getValue(this, i * h);
+		if (i < 5) {
+			dy[i] = getDerivative(this, i * h);
+		}
+		if (i < 4) {
+			ddy[i] = getSecondDerivative(this, i * h);
+		}
+	}
+	initDifferences(y, 5);
+	initDifferences(dy, 4);
+	initDifferences(ddy, 3);
+
+	float cosTheta = cos(this->thetaOffset);
+	float sinTheta = sin(this->thetaOffset);
+	float stepX = h * cosTheta;
+	float stepY = h * sinTheta;
+	float x = this->xOffset - y[0] * sinTheta;
+	float worldY = this->yOffset + y[0] * cosTheta;
+
+	for (short i = 0; i < count; i++) {
+		float q = 1.0 + dy[0] * dy[0];
+
+		points[i].x = x;
+		points[i].y = worldY;
+		points[i].heading = boundAngle0To2PiRadians(this->thetaOffset + atan(dy[0]));
+		points[i].curvature = ddy[0] / (q * sqrt(q));
+
+		// Rotate the step in the spline's basis into world coordinates.
+		x += stepX - y[1] * sinTheta;
+		worldY += stepY + y[1] * cosTheta;
+
+		stepDifferences(y, 5);
+		stepDifferences(dy, 4);
+		stepDifferences(ddy, 3);
+	}
+	return count;
+}
+
 void print(Spline *this) {
 	if (this == NULL) {
 		return;
@@ -75,13 +397,16 @@ void print(Spline *this) {
 			this->c, this->d, this->e);
 	writeDebugStream("xOffset=%f; yOffset=%f; thetaOffset=%f\n", this->xOffset,
 			this->yOffset, this->thetaOffset);
+	writeDebugStream("knotDistance=%f; arcLength=%f\n", this->knotDistance,
+			this->arcLength);
 }
 
-task main() {
-	Spline spline;
-	newSpline(&spline, 0.0, 0.0, 0.0, 10.0, 0.0, 0.7);
-	clearDebugStream();
-	print(&spline);
+void print(SplinePoint *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("x=%f; y=%f; heading=%f; curvature=%f\n", this->x, this->y,
+			this->heading, this->curvature);
 }
 
 #endif  // SPLINE_C_
@@ -0,0 +1,67 @@
+#pragma systemFile
+
+#if !defined(TRAJECTORY_C_)
+#define TRAJECTORY_C_
+
+// Layout of one sample in a generated trajectory table.
+#define TRAJECTORY_X           	0
+#define TRAJECTORY_Y           	1
+#define TRAJECTORY_HEADING     	2
+#define TRAJECTORY_CURVATURE   	3
+#define TRAJECTORY_POSITION    	4
+#define TRAJECTORY_VELOCITY    	5
+#define TRAJECTORY_ACCELERATION	6
+#define TRAJECTORY_STRIDE      	7
+
+typedef struct {
+	float x;
+	float y;
+	float heading;
+	float curvature;
+
+	float position;  // Distance along the path.
+	float velocity;
+	float acceleration;
+} TrajectoryPoint;
+
+/**
+ * Read a sample from a trajectory table produced by
+ * tools/trajectoryGenerator.c.
+ *
+ * @param 	table	Trajectory table.
+ * @param 	size 	Number of samples in the table.
+ * @param 	index	Sample to read. Reads past the end return the last sample.
+ * @param 	point	Pointer to TrajectoryPoint struct to store the sample in.
+ */
+void getTrajectoryPoint(const float *table, short size, short index,
+		TrajectoryPoint *point) {
+	if (table == NULL || point == NULL || size <= 0) {
+		return;
+	}
+	if (index >= size) {
+		index = size - 1;
+	} else if (index < 0) {
+		index = 0;
+	}
+	short i = index * TRAJECTORY_STRIDE;
+
+	point->x = table[i + TRAJECTORY_X];
+	point->y = table[i + TRAJECTORY_Y];
+	point->heading = table[i + TRAJECTORY_HEADING];
+	point->curvature = table[i + TRAJECTORY_CURVATURE];
+	point->position = table[i + TRAJECTORY_POSITION];
+	point->velocity = table[i + TRAJECTORY_VELOCITY];
+	point->acceleration = table[i + TRAJECTORY_ACCELERATION];
+}
+
+void print(TrajectoryPoint *this) {
+	if (this == NULL) {
+		return;
+	}
+	writeDebugStream("x=%f; y=%f; heading=%f; curvature=%f\n", this->x, this->y,
+			this->heading, this->curvature);
+	writeDebugStream("position=%f; velocity=%f; acceleration=%f\n",
+			this->position, this->velocity, this->acceleration);
+}
+
+#endif  // TRAJECTORY_C_
@@ -3,36 +3,23 @@
 #if !defined(WAYPOINT_C_)
 #define WAYPOINT_C_
 
-typedef struct Waypoint {
+typedef struct {
 	float x;
 	float y;
 	float theta;
-
-	struct Waypoint *next;
 } Waypoint;
 
-Waypoint *newWaypoint(Waypoint *this, float x, float y, float theta,
-		Waypoint *next) {
+Waypoint *newWaypoint(Waypoint *this, float x, float y, float theta) {
 	if (this) {
 		this->x = x;
 		this->y = y;
 		this->theta = theta;
-
-		this->next = next;
 	}
 	return this;
 }
 
-Waypoint *newWaypoint(Waypoint *this, float x, float y, float theta) {
-	return newWaypoint(this, x, y, theta, NULL);
-}
-
-Waypoint *newWaypoint(Waypoint *this, Waypoint *next) {
-	return newWaypoint(this, 0.0, 0.0, 0.0, next);
-}
-
 Waypoint *newWaypoint(Waypoint *this) {
-	return newWaypoint(this, 0.0, 0.0, 0.0, NULL);
+	return newWaypoint(this, 0.0, 0.0, 0.0);
 }
 
 float getX(Waypoint *this) {
@@ -65,16 +52,6 @@ void setTheta(Waypoint *this, float theta) {
 	}
 }
 
-Waypoint *getNext(Waypoint *this) {
-	return this ? this->next : NULL;
-}
-
-void setNext(Waypoint *this, Waypoint *next) {
-	if (this) {
-		this->next = next;
-	}
-}
-
 void print(Waypoint *this) {
 	if (this == NULL) {
 		return;
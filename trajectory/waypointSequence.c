@@ -3,49 +3,163 @@
 #if !defined(WAYPOINTSEQUENCE_C_)
 #define WAYPOINTSEQUENCE_C_
 
+#define WAYPOINTSEQUENCE_CAPACITY	16
+
+#include "../util/math.c"
 #include "./waypoint.c"
 
 typedef struct {
-	Waypoint *head;
-	Waypoint *tail;
+	short size;
+	Waypoint waypoints[WAYPOINTSEQUENCE_CAPACITY];
 } WaypointSequence;
 
-WaypointSequence *newWaypointSequence(WaypointSequence *this, Waypoint *head,
-		Waypoint *tail) {
+WaypointSequence *newWaypointSequence(WaypointSequence *this) {
 	if (this) {
-		this->head = head;
-		this->tail = tail;
+		this->size = 0;
 	}
 	return this;
 }
 
-WaypointSequence *newWaypointSequence(WaypointSequence *this, Waypoint *head) {
-	if (this == NULL || head == NULL) {
+short getSize(WaypointSequence *this) {
+	return this ? this->size : 0;
+}
+
+bool isFull(WaypointSequence *this) {
+	return this ? this->size >= WAYPOINTSEQUENCE_CAPACITY : true;
+}
+
+void clear(WaypointSequence *this) {
+	if (this) {
+		this->size = 0;
+	}
+}
+
+Waypoint *getWaypoint(WaypointSequence *this, short index) {
+	return (this != NULL && index >= 0 && index < this->size)
+			? &this->waypoints[index] : NULL;
+}
+
+/**
+ * Append a waypoint.
+ *
+ * @param 	this 	Pointer to WaypointSequence struct.
+ * @param 	x    	x.
+ * @param 	y    	y.
+ * @param 	theta	Heading (radians).
+ *
+ * @return	Pointer to the stored waypoint, or NULL if the sequence is full.
+ */
+Waypoint *addWaypoint(WaypointSequence *this, float x, float y, float theta) {
+	if (isFull(this)) {
 		return NULL;
 	}
-	Waypoint *current = head;
+	return newWaypoint(&this->waypoints[this->size++], x, y, theta);
+}
 
-	// Find tail.
-	while (current->next) {
-		current = current->next;
+Waypoint *addWaypoint(WaypointSequence *this, Waypoint *waypoint) {
+	if (waypoint == NULL) {
+		return NULL;
 	}
-	this->head = head;
-	this->tail = current;
+	return addWaypoint(this, waypoint->x, waypoint->y, waypoint->theta);
+}
 
-	return this;
+/**
+ * Insert a waypoint before index, shifting later waypoints back.
+ *
+ * @param 	this 	Pointer to WaypointSequence struct.
+ * @param 	index	Index of the new waypoint, at most the current size.
+ * @param 	x    	x.
+ * @param 	y    	y.
+ * @param 	theta	Heading (radians).
+ *
+ * @return	Pointer to the stored waypoint, or NULL if the sequence is full
+ *        	or index is out of range.
+ */
+Waypoint *insertWaypoint(WaypointSequence *this, short index, float x, float y,
+		float theta) {
+	if (isFull(this) || index < 0 || index > this->size) {
+		return NULL;
+	}
+	for (short i = this->size; i > index; i--) {
+		this->waypoints[i] = this->waypoints[i - 1];
+	}
+	this->size++;
+
+	return newWaypoint(&this->waypoints[index], x, y, theta);
 }
-/*
-WaypointSequence *addWaypoint(WaypointSquence *this, Waypoint *new) {
-	if (this) {
-		if (!this->head) {  // 0 Waypoints.
-			this->head = new;
-		} else if (!this->tail) {  // 1 Waypoint.
-			this->head->next = new;
-			this->tail = new;
-		} else {
-			this->
-		}
+
+/**
+ * Remove a waypoint, shifting later waypoints forward.
+ *
+ * @param 	this 	Pointer to WaypointSequence struct.
+ * @param 	index	Index of the waypoint to remove.
+ *
+ * @return	true if a waypoint was removed, false otherwise.
+ */
+bool removeWaypoint(WaypointSequence *this, short index) {
+	if (this == NULL || index < 0 || index >= this->size) {
+		return false;
+	}
+	this->size--;
+	for (short i = index; i < this->size; i++) {
+		this->waypoints[i] = this->waypoints[i + 1];
+	}
+	return true;
+}
+
+void translate(WaypointSequence *this, float dx, float dy) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		this->waypoints[i].x += dx;
+		this->waypoints[i].y += dy;
+	}
+}
+
+/**
+ * Mirror every waypoint across the vertical line at x, e.g. to run a
+ * routine from the other alliance's side of the field.
+ *
+ * @param 	this	Pointer to WaypointSequence struct.
+ * @param 	x   	x of the line to mirror across.
+ */
+void mirrorX(WaypointSequence *this, float x) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		this->waypoints[i].x = 2.0 * x - this->waypoints[i].x;
+		this->waypoints[i].theta = boundAngle0To2PiRadians(PI
+				- this->waypoints[i].theta);
 	}
 }
-*/
+
+/**
+ * Mirror every waypoint across the horizontal line at y.
+ *
+ * @param 	this	Pointer to WaypointSequence struct.
+ * @param 	y   	y of the line to mirror across.
+ */
+void mirrorY(WaypointSequence *this, float y) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		this->waypoints[i].y = 2.0 * y - this->waypoints[i].y;
+		this->waypoints[i].theta = boundAngle0To2PiRadians(
+				-this->waypoints[i].theta);
+	}
+}
+
+void print(WaypointSequence *this) {
+	if (this == NULL) {
+		return;
+	}
+	for (short i = 0; i < this->size; i++) {
+		writeDebugStream("%d: x=%f; y=%f; theta=%f\n", i, this->waypoints[i].x,
+				this->waypoints[i].y, this->waypoints[i].theta);
+	}
+}
+
 #endif  // WAYPOINTSEQUENCE_C_